@@ -0,0 +1,79 @@
+/*
+ goisLeanLed
+
+ Receiver for the leanLed frame protocol (see src/leanLed.h), used with
+ exGois_arduinoLED --serial-lean instead of StandardFirmata:
+
+   0xA5  N  v0 v1 .. vN-1  crc8(N, v0..vN-1)
+
+ Channel i drives pins[i] with analogWrite(v). Frames with a bad CRC, or
+ with N other than NUM_CHANNELS, are dropped: a frame laid out for other
+ pins would light the wrong LEDs.
+
+ The host has the same table as LEAN_SKETCH_PINS in src/leanLed.h and
+ only accepts lean devices listing exactly these pins, in this order.
+ To drive other pins (up to the board's PWM pins) change pins[] and
+ NUM_CHANNELS here and LEAN_SKETCH_PINS / LEAN_SKETCH_CHANNELS there.
+ */
+
+#define BAUD 57600
+#define LEAN_SYNC 0xA5
+#define LEAN_MAX_CHANNELS 250
+#define NUM_CHANNELS 4
+
+const int pins[NUM_CHANNELS] = {3, 5, 6, 9};
+
+enum { WAIT_SYNC, LENGTH, DATA, CRC } state = WAIT_SYNC;
+uint8_t buf[LEAN_MAX_CHANNELS];
+int expected = 0;
+int received = 0;
+uint8_t crc = 0;
+
+uint8_t crcStep(uint8_t c, uint8_t b){
+    c ^= b;
+    for(int i=0;i<8;i++)c = c & 0x80 ? (c << 1) ^ 0x07 : c << 1;
+    return c;
+}
+
+void apply(){
+    if(expected != NUM_CHANNELS)return;
+    for(int i=0;i<NUM_CHANNELS;i++)analogWrite(pins[i], buf[i]);
+}
+
+void setup(){
+    for(int i=0;i<NUM_CHANNELS;i++){
+        pinMode(pins[i], OUTPUT);
+        analogWrite(pins[i], 0);
+    }
+    Serial.begin(BAUD);
+}
+
+void loop(){
+    while(Serial.available()){
+        uint8_t b = Serial.read();
+        switch(state){
+            case WAIT_SYNC:
+                if(b == LEAN_SYNC)state = LENGTH;
+                break;
+            case LENGTH:
+                if(b == 0 || b > LEAN_MAX_CHANNELS){
+                    state = b == LEAN_SYNC ? LENGTH : WAIT_SYNC;
+                    break;
+                }
+                expected = b;
+                received = 0;
+                crc = crcStep(0, b);
+                state = DATA;
+                break;
+            case DATA:
+                buf[received++] = b;
+                crc = crcStep(crc, b);
+                if(received == expected)state = CRC;
+                break;
+            case CRC:
+                if(b == crc)apply();
+                state = WAIT_SYNC;
+                break;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "analysisThread.h"
+#include "latencyTrace.h"
+
+analysisThread::analysisThread(){
+    ring = NULL;
+    profiler = NULL;
+    analyzed = 0;
+    busyMicros = 0;
+    maxMicros = 0;
+    current = analysisResult();
+    tuningSeq = 0;
+    appliedSeq = 0;
+    bResetMax = false;
+}
+
+void analysisThread::setup(audioRing *r, const fft &f, stageProfiler *p){
+    ring = r;
+    profiler = p;
+    bands = f;
+    analyzer.setup(&bands);
+}
+
+void analysisThread::setParams(const fft &f){
+    tuning &t = tunings.back();
+    t.seq = ++tuningSeq;
+    f.getParams(t.params);
+    tunings.publish();
+}
+
+void analysisThread::resetMax(){
+    bResetMax = true;
+}
+
+const analysisResult & analysisThread::latest(analysisReader reader){
+    return results[reader].latest();
+}
+
+int analysisThread::processPending(){
+    int n = 0;
+    const audioBlock * block;
+    while((block = ring->front()) != NULL){
+        const tuning &t = tunings.latest();
+        if(t.seq != appliedSeq){
+            bands.setParams(t.params);
+            appliedSeq = t.seq;
+        }
+        if(bResetMax.exchange(false)){
+            for(int i=0;i<BAND_NUM;i++)bands.vol_max[i] = 0;
+        }
+        uint64_t start = ofGetElapsedTimeMicros();
+        analyzer.process(block->left, current);
+        TRACE_STAGE(block->seq, TRACE_ANALYSIS);
+        uint64_t took = ofGetElapsedTimeMicros() - start;
+        busyMicros += took;
+        // an atomic max: the metrics reader may exchange it to 0 at any time
+        uint64_t m = maxMicros.load(std::memory_order_relaxed);
+        while(took > m && !maxMicros.compare_exchange_weak(m, took, std::memory_order_relaxed));
+        if(profiler != NULL){
+            profiler->add(PROFILE_POWER_SPECTRUM, analyzer.spectrumMicros);
+            profiler->add(PROFILE_BAND_UPDATE, analyzer.bandMicros);
+        }
+        current.seq++;
+        current.blockSeq = block->seq;
+        current.micros = block->micros;
+        ring->release();
+        analyzed++;
+        n++;
+
+        for(int i=0;i<READER_NUM;i++){
+            results[i].back() = current;
+            results[i].publish();
+        }
+        spectrum.send(current);
+    }
+    return n;
+}
+
+void analysisThread::threadedFunction(){
+    while(isThreadRunning()){
+        if(processPending() == 0){
+            // a block is ~5.8ms, polling at 1ms keeps the audio thread free of any wake-up call
+            sleep(1);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofMain.h"
+#include "audioRing.h"
+#include "bandAnalyzer.h"
+#include "tripleBuffer.h"
+#include "stageProfiler.h"
+#include "spectrumStream.h"
+
+/*
+ analysisThread
+
+ Drains the audio ring and runs bandAnalyzer on every block, off the GL
+ thread. Each consumer (render, LED, OSC) gets its own triple buffer so
+ all of them can read the most recent result without locking.
+
+ The thread analyzes with its own copy of the fft tuning. The main thread
+ edits its fft and hands every change over with setParams(); the copy is
+ swapped in between two blocks, so a block never sees a half-written
+ parameter set.
+ */
+
+enum analysisReader {
+    READER_RENDER,
+    READER_LED,
+    READER_OSC,
+    READER_NUM
+};
+
+class analysisThread : public ofThread {
+
+public:
+    analysisThread();
+
+    void setup(audioRing *r, const fft &f, stageProfiler *p = NULL);
+    const analysisResult & latest(analysisReader reader);
+    /* main thread: new tuning, used from the next block on */
+    void setParams(const fft &f);
+    /* main thread: forget the band peaks (fft::vol_max) before the next block */
+    void resetMax();
+    /* analyze everything queued in the ring on the calling thread (used by replay) */
+    int processPending();
+    
+    spectrumStream spectrum;            // optional per-block spectrum output, see spectrumStream.h
+
+    std::atomic<uint64_t> analyzed;     // blocks analyzed so far
+    std::atomic<uint64_t> busyMicros;   // total time spent analyzing
+    std::atomic<uint64_t> maxMicros;    // slowest block since the reader last reset it
+
+protected:
+    void threadedFunction();
+
+private:
+    struct tuning {
+        uint64_t seq;
+        fftParams params;
+    };
+
+    audioRing *ring;
+    stageProfiler *profiler;
+    bandAnalyzer analyzer;
+    fft bands;                          // analysis side, never touched by the main thread
+    tripleBuffer<tuning> tunings;
+    uint64_t tuningSeq;                 // main thread
+    uint64_t appliedSeq;                // analysis side
+    std::atomic<bool> bResetMax;
+    analysisResult current;
+    tripleBuffer<analysisResult> results[READER_NUM];
+};
@@ -0,0 +1,122 @@
+#include "appConfig.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+appConfig::appConfig(){
+    headless = false;
+    rate = 100;
+    bpm = 0;
+    ledMode = 1;
+    oscRate = 60;
+    oscPerBand = false;
+    oscKeyframe = 1;
+    spectrumPort = 0;
+    spectrumF16 = false;
+    serialPort = "/dev/cu.usbmodem1411";
+    baud = 57600;
+    mockArduino = false;
+    serialBench = 0;
+    serialLean = false;
+    serialRate = 250;
+    ledRate = 250;
+    gamma = 2.2;
+    dither = false;
+    metricsInterval = 1;
+    recordMB = 2048;    // ~1.5h of stereo audio blocks
+    analyze = false;
+    csv = false;
+    threads = 0;
+}
+
+bool appConfig::parse(int argc, char *argv[]){
+    for(int i=1;i<argc;i++){
+        const char *arg = argv[i];
+        bool hasValue = i+1 < argc;
+        if(strcmp(arg, "--headless") == 0)headless = true;
+        else if(strcmp(arg, "--rate") == 0 && hasValue)rate = atoi(argv[++i]);
+        else if(strcmp(arg, "--bpm") == 0 && hasValue)bpm = atof(argv[++i]);
+        else if(strcmp(arg, "--led-mode") == 0 && hasValue)ledMode = atoi(argv[++i]);
+        else if(strcmp(arg, "--osc-dest") == 0 && hasValue)oscDests.push_back(argv[++i]);
+        else if(strcmp(arg, "--osc-rate") == 0 && hasValue)oscRate = atof(argv[++i]);
+        else if(strcmp(arg, "--osc-per-band") == 0)oscPerBand = true;
+        else if(strcmp(arg, "--osc-delta") == 0 && hasValue){
+            char *p = argv[++i];
+            do{
+                oscDelta.push_back(strtod(p, &p));
+            }while(*p++ == ',');
+        }
+        else if(strcmp(arg, "--osc-keyframe") == 0 && hasValue)oscKeyframe = atof(argv[++i]);
+        else if(strcmp(arg, "--spectrum-port") == 0 && hasValue)spectrumPort = atoi(argv[++i]);
+        else if(strcmp(arg, "--spectrum-f16") == 0)spectrumF16 = true;
+        else if(strcmp(arg, "--serial") == 0 && hasValue)serialPort = argv[++i];
+        else if(strcmp(arg, "--baud") == 0 && hasValue)baud = atoi(argv[++i]);
+        else if(strcmp(arg, "--mock-arduino") == 0)mockArduino = true;
+        else if(strcmp(arg, "--mock-log") == 0 && hasValue)mockLog = argv[++i];
+        else if(strcmp(arg, "--serial-bench") == 0 && hasValue)serialBench = atof(argv[++i]);
+        else if(strcmp(arg, "--serial-lean") == 0)serialLean = true;
+        else if(strcmp(arg, "--serial-rate") == 0 && hasValue)serialRate = atof(argv[++i]);
+        else if(strcmp(arg, "--led-rate") == 0 && hasValue)ledRate = atof(argv[++i]);
+        else if(strcmp(arg, "--devices") == 0 && hasValue)devicesPath = argv[++i];
+        else if(strcmp(arg, "--metrics") == 0 && hasValue)metricsInterval = atof(argv[++i]);
+        else if(strcmp(arg, "--gamma") == 0 && hasValue)gamma = atof(argv[++i]);
+        else if(strcmp(arg, "--dither") == 0)dither = true;
+        else if(strcmp(arg, "--patterns") == 0 && hasValue)patternsPath = argv[++i];
+        else if(strcmp(arg, "--show") == 0 && hasValue)showTrack = argv[++i];
+        else if(strcmp(arg, "--bands") == 0 && hasValue)showBands = argv[++i];
+        else if(strcmp(arg, "--record") == 0 && hasValue)recordPath = argv[++i];
+        else if(strcmp(arg, "--record-mb") == 0 && hasValue)recordMB = atoi(argv[++i]);
+        else if(strcmp(arg, "--replay") == 0 && hasValue)replayPath = argv[++i];
+        else if(strcmp(arg, "--analyze") == 0)analyze = true;
+        else if(strcmp(arg, "--csv") == 0)csv = true;
+        else if(strcmp(arg, "--threads") == 0 && hasValue)threads = atoi(argv[++i]);
+        else if(strcmp(arg, "--out") == 0 && hasValue)outDir = argv[++i];
+        else if(strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)return false;
+        else if(arg[0] != '-')files.push_back(arg);
+        else if(strncmp(arg, "-psn_", 5) == 0)continue;     // Finder's process serial number
+        else if(strncmp(arg, "-NS", 3) == 0 || strncmp(arg, "-Apple", 6) == 0){
+            // Cocoa user defaults from Xcode / launchd, e.g. -NSDocumentRevisionsDebugMode YES
+            if(hasValue && argv[i+1][0] != '-')i++;
+        }
+        else fprintf(stderr, "ignoring unknown option: %s\n", arg);
+    }
+    return true;
+}
+
+void appConfig::printUsage() const{
+    fprintf(stderr,
+            "usage: exGois_arduinoLED [options]\n"
+            "  --headless        run without a window (audio, beat clock, OSC and LED only)\n"
+            "  --rate N          loop rate in Hz when headless, 0 = one loop per audio block\n"
+            "  --bpm N           start the beat clock at N bpm\n"
+            "  --led-mode N      initial ledMode 1-4\n"
+            "  --gamma G         PWM gamma correction (default 2.2, 1 = linear)\n"
+            "  --dither          temporal dither on PWM output, finer dim levels\n"
+            "  --patterns FILE   step patterns for ledMode 3, switched with /scene or TAB\n"
+            "  --osc-dest H:P    OSC output destination, repeatable (default localhost:9000)\n"
+            "  --osc-rate N      OSC output bundles per second (default 60)\n"
+            "  --osc-per-band    also send one /vol/N address per band\n"
+            "  --osc-delta E     send only bands that moved more than E (or E0,E1,E2,E3)\n"
+            "  --osc-keyframe S  full bundle every S seconds in delta mode (default 1)\n"
+            "  --spectrum-port N stream every block's spectrum as /spec blobs to port N\n"
+            "  --spectrum-f16    spectrum as half floats instead of 8 bit dB\n"
+            "  --serial PORT     Arduino serial port (default /dev/cu.usbmodem1411)\n"
+            "  --baud N          serial baud rate (default 57600)\n"
+            "  --mock-arduino    simulated board on a pseudo-terminal, no hardware needed\n"
+            "  --mock-log FILE   CSV of every pin write the simulated board received\n"
+            "  --serial-bench N  run each ledMode N seconds on the simulated board, print stats, quit\n"
+            "  --serial-lean     use the leanLed protocol instead of Firmata\n"
+            "  --serial-rate N   serial output flushes per second (default 250)\n"
+            "  --led-rate N      LED output ticks per second, 0 = once per frame (default 250)\n"
+            "  --devices FILE    LED boards and their pins, one \"PORT BAUD firmata|lean PIN...\" per line\n"
+            "  --metrics N       publish /metrics every N seconds, 0 = off (default 1)\n"
+            "  --show TRACK      play TRACK with its pre-analyzed band curves, no live FFT\n"
+            "  --bands FILE      band curve file for --show (default: TRACK.bands)\n"
+            "  --record FILE     log all input/output events to FILE\n"
+            "  --record-mb N     space reserved for the log in MB (default 2048)\n"
+            "  --replay FILE     re-drive the app from a recorded log\n"
+            "  --analyze FILES   write band curves for WAV files and exit\n"
+            "    --csv           write CSV instead of binary .bands\n"
+            "    --threads N     worker threads (default: all cores)\n"
+            "    --out DIR       output directory (default: next to each file)\n");
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ appConfig
+
+ Run options taken from the command line, e.g.
+
+   exGois_arduinoLED --headless --rate 100 --bpm 120 --led-mode 3
+
+ --headless          no window / GL context, draw() is skipped
+ --rate N            loop rate in Hz when headless (0 = wait for audio blocks)
+ --bpm N             start the beat clock at N bpm on launch
+ --led-mode N        initial ledMode (1-4)
+ --gamma G           PWM gamma correction (default 2.2, 1 = linear)
+ --dither            sigma-delta dither the PWM for smoother dark fades (more serial traffic)
+ --patterns FILE     step patterns for ledMode 3, one scene each (see ledSequencer.h)
+ --show TRACK        play TRACK and drive LEDs / OSC from its pre-analyzed
+                     band curves (TRACK.bands, see --analyze) instead of live FFT
+ --bands FILE        band curve file for --show if it isn't next to the track
+ --osc-dest HOST:PORT send band/beat/onset/metrics output here; repeat for more
+                     receivers (default localhost:9000)
+ --osc-rate N        band/beat/onset bundles per second (default 60)
+ --osc-per-band      also send /vol/0../vol/3 with one float each
+ --osc-delta E[,E..] only send bands that moved more than E (one value, or one per band)
+ --osc-keyframe S    with --osc-delta, send the full bundle every S seconds (default 1)
+ --spectrum-port N   stream the full spectrum of every block to HOST:N as /spec blobs
+ --spectrum-f16      send half floats instead of 8 bit dB
+ --serial PORT       Arduino serial port (default /dev/cu.usbmodem1411)
+ --baud N            serial baud rate (default 57600)
+ --mock-arduino      talk to a simulated board on a pseudo-terminal instead (see mockArduino.h)
+ --mock-log FILE     CSV of every pin write the mock board received
+ --serial-bench N    with the mock board: run each ledMode for N seconds, print
+                     serial throughput and latency, then quit
+ --serial-lean       talk the leanLed protocol (arduino/goisLeanLed) instead of Firmata
+ --serial-rate N     serial flushes per second (default 250)
+ --led-rate N        LED output ticks per second on their own thread (default 250,
+                     0 = once per frame in the render loop)
+ --devices FILE      drive several boards: one "PORT BAUD firmata|lean PIN..." per
+                     line, channels numbered across them (see deviceRegistry.h);
+                     replaces --serial / --baud / --serial-lean
+ --metrics N         publish /metrics every N seconds (0 = off)
+ --record FILE       log every input and output event to FILE (see eventLog.h)
+ --record-mb N       space reserved for the log, in MB
+ --replay FILE       re-drive the app from a recorded log instead of live input;
+                     with --headless --rate 0 it runs as fast as possible
+
+ or, without starting the app at all,
+
+   exGois_arduinoLED --analyze [--csv] [--threads N] [--out DIR] a.wav b.wav ...
+
+ Unknown options are reported and skipped rather than fatal: macOS hands
+ the app its own arguments (-psn_..., -NSDocumentRevisionsDebugMode YES)
+ and those are passed over quietly. --help prints the usage and exits.
+ */
+
+struct appConfig {
+    appConfig();
+    bool parse(int argc, char *argv[]);
+    void printUsage() const;
+
+    bool headless;
+    int rate;
+    float bpm;
+    int ledMode;
+    std::vector<std::string> oscDests;
+    float oscRate;
+    bool oscPerBand;
+    std::vector<float> oscDelta;
+    float oscKeyframe;
+    int spectrumPort;
+    bool spectrumF16;
+    std::string serialPort;
+    int baud;
+    bool mockArduino;
+    std::string mockLog;
+    std::string devicesPath;
+    std::string patternsPath;
+    float gamma;
+    bool dither;
+    float serialBench;
+    bool serialLean;
+    float serialRate;
+    float ledRate;
+    float metricsInterval;
+    std::string showTrack;
+    std::string showBands;
+    std::string recordPath;
+    int recordMB;
+    std::string replayPath;
+    
+    /* offline analysis */
+    bool analyze;
+    bool csv;
+    int threads;
+    std::string outDir;
+    std::vector<std::string> files;
+};
@@ -0,0 +1,53 @@
+#include "audioRing.h"
+#include <stddef.h>
+
+audioRing::audioRing(){
+    received = 0;
+    overruns = 0;
+    head = 0;
+    tail = 0;
+}
+
+bool audioRing::push(const float *input, int bufferSize, int nChannels, uint64_t micros){
+    uint64_t seq = received.fetch_add(1, std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(h - tail.load(std::memory_order_acquire) >= RING_BLOCKS){
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    audioBlock &b = blocks[h & (RING_BLOCKS - 1)];
+    if(bufferSize > BUFFER_SIZE)bufferSize = BUFFER_SIZE;
+    b.seq = seq;
+    b.micros = micros;
+    b.bufferSize = bufferSize;
+    // samples are "interleaved"
+    if(nChannels >= 2){
+        for(int i = 0; i < bufferSize; i++){
+            b.left[i] = input[i*nChannels];
+            b.right[i] = input[i*nChannels+1];
+        }
+    }else{
+        for(int i = 0; i < bufferSize; i++){
+            b.left[i] = b.right[i] = input[i];
+        }
+    }
+    for(int i = bufferSize; i < BUFFER_SIZE; i++)b.left[i] = b.right[i] = 0;
+
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+const audioBlock * audioRing::front(){
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    if(head.load(std::memory_order_acquire) == t)return NULL;
+    return &blocks[t & (RING_BLOCKS - 1)];
+}
+
+void audioRing::release(){
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+int audioRing::available() const{
+    return (int)(head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire));
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#define BUFFER_SIZE 256
+#define RING_BLOCKS 32      // must be a power of two
+
+/*
+ audioRing
+
+ Wait-free single-producer / single-consumer ring of fixed-size stereo
+ blocks. audioReceived() is the only producer, the analysis side is the
+ only consumer. The producer never blocks or allocates: when the ring is
+ full the incoming block is dropped and counted in `overruns`.
+ */
+
+struct audioBlock {
+    uint64_t seq;           // running block number (counts dropped blocks too)
+    uint64_t micros;        // capture time, ofGetElapsedTimeMicros()
+    int bufferSize;
+    float left[BUFFER_SIZE];
+    float right[BUFFER_SIZE];
+};
+
+class audioRing {
+
+public:
+    audioRing();
+
+    /* producer (audio thread) */
+    bool push(const float *input, int bufferSize, int nChannels, uint64_t micros);
+
+    /* consumer: peek the oldest block, then release it when done */
+    const audioBlock * front();
+    void release();
+    int available() const;
+
+    std::atomic<uint64_t> received;     // blocks offered by the audio thread
+    std::atomic<uint64_t> overruns;     // blocks dropped because the ring was full
+
+private:
+    audioBlock blocks[RING_BLOCKS];
+    // head and tail live on separate cache lines so the two threads don't fight
+    char pad0[64];
+    std::atomic<uint32_t> head;     // written by the producer
+    char pad1[64];
+    std::atomic<uint32_t> tail;     // written by the consumer
+    char pad2[64];
+};
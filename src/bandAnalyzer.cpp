@@ -0,0 +1,51 @@
+#include "bandAnalyzer.h"
+#include <chrono>
+
+static float microsSince(std::chrono::steady_clock::time_point start){
+    return std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+bandAnalyzer::bandAnalyzer(){
+    myfft = 0;
+    onsetRatio = 1.5;
+    onsetFloor = 0.1;
+    onsetHold = 16;     // about 90ms at 256 samples / 44.1kHz
+    spectrumMicros = 0;
+    bandMicros = 0;
+    for(int i=0;i<BAND_NUM;i++){
+        envelope[i] = 0;
+        hold[i] = 0;
+        onsetTotal[i] = 0;
+    }
+}
+
+void bandAnalyzer::setup(fft *f){
+    myfft = f;
+}
+
+void bandAnalyzer::process(const float *samples, analysisResult &out){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    myfft->powerSpectrum(0, (int)BUFFER_SIZE/2, (float *)samples, BUFFER_SIZE, &out.magnitude[0], &phase[0], &power[0], &out.avg_power);
+    spectrumMicros = microsSince(start);
+    start = std::chrono::steady_clock::now();
+
+    for(int i=0;i<BAND_NUM;i++){
+        myfft->update(out.magnitude, i);
+        float v = myfft->val[i];
+        out.val[i] = v;
+        out.level[i] = myfft->temp_val;
+        out.map_max[i] = myfft->map_max[i];
+
+        /*-------onset: jump above the slow envelope-------*/
+        out.onset[i] = false;
+        if(hold[i] > 0)hold[i]--;
+        else if(v > envelope[i]*onsetRatio + onsetFloor){
+            out.onset[i] = true;
+            hold[i] = onsetHold;
+            onsetTotal[i]++;
+        }
+        out.onsetCount[i] = onsetTotal[i];
+        envelope[i] = 0.95*envelope[i] + 0.05*v;
+    }
+    bandMicros = microsSince(start);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include "fft.h"
+#include "audioRing.h"
+
+/*
+ bandAnalyzer
+
+ The per-block analysis pipeline: Hanning window + FFT (fft::powerSpectrum),
+ band mapping (fft::update) and a simple per-band onset detector.
+ It has no openFrameworks dependency so the same code can run live on the
+ analysis thread and offline over decoded files.
+ */
+
+struct analysisResult {
+    uint64_t seq;                       // analysis sequence number (0 = nothing yet)
+    uint64_t blockSeq;                  // audioBlock::seq this result was computed from
+    uint64_t micros;                    // capture time of that block
+    float magnitude[BUFFER_SIZE/2];
+    float avg_power;
+    float val[BAND_NUM];
+    float level[BAND_NUM];              // band average before mapping (fft::temp_val)
+    float map_max[BAND_NUM];            // mapping bound in effect, follows the peaks with bAutoMaxGet
+    bool onset[BAND_NUM];
+    uint32_t onsetCount[BAND_NUM];      // onsets since setup, so readers that skip results don't lose any
+};
+
+class bandAnalyzer {
+
+public:
+    bandAnalyzer();
+
+    void setup(fft *f);
+    /* analyze one BUFFER_SIZE block of mono samples */
+    void process(const float *samples, analysisResult &out);
+
+    float onsetRatio;       // onset when val > envelope * onsetRatio + onsetFloor
+    float onsetFloor;
+    int onsetHold;          // blocks to wait before the same band may fire again
+
+    float spectrumMicros;   // time spent in powerSpectrum during the last process()
+    float bandMicros;       // time spent in band update + onsets
+
+private:
+    fft *myfft;
+    float phase[BUFFER_SIZE];
+    float power[BUFFER_SIZE];
+    float envelope[BAND_NUM];
+    int hold[BAND_NUM];
+    uint32_t onsetTotal[BAND_NUM];
+};
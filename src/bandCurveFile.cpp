@@ -0,0 +1,119 @@
+#include "bandCurveFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+bandCurveMap::bandCurveMap(){
+    header = NULL;
+    frames = NULL;
+    data = NULL;
+    size = 0;
+}
+
+bandCurveMap::~bandCurveMap(){
+    close();
+}
+
+bool bandCurveMap::open(const std::string &path){
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        error = "can't open " + path;
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(bandCurveHeader)){
+        ::close(fd);
+        error = path + " is too short";
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if(p == MAP_FAILED){
+        error = "can't map " + path;
+        return false;
+    }
+    data = p;
+    size = st.st_size;
+
+    const bandCurveHeader *h = (const bandCurveHeader *)data;
+    if(memcmp(h->magic, "GBND", 4) != 0 || h->version != BAND_CURVE_VERSION || h->bandNum != BAND_NUM || h->hop == 0 || h->sampleRate == 0
+       || sizeof(bandCurveHeader) + (size_t)h->frameCount * sizeof(bandCurveFrame) > size){
+        error = path + " is not a compatible band curve file";
+        close();
+        return false;
+    }
+    header = h;
+    frames = (const bandCurveFrame *)(h + 1);
+    return true;
+}
+
+void bandCurveMap::close(){
+    if(data != NULL)munmap(data, size);
+    data = NULL;
+    size = 0;
+    header = NULL;
+    frames = NULL;
+}
+
+bool bandCurveMap::isOpen() const{
+    return header != NULL;
+}
+
+const bandCurveFrame * bandCurveMap::frameAt(double seconds) const{
+    if(header == NULL || header->frameCount == 0)return NULL;
+    if(seconds < 0)seconds = 0;
+    size_t n = (size_t)(seconds * header->sampleRate / header->hop);
+    if(n >= header->frameCount)n = header->frameCount - 1;
+    return &frames[n];
+}
+
+double bandCurveMap::duration() const{
+    if(header == NULL)return 0;
+    return header->frameCount * (double)header->hop / header->sampleRate;
+}
+
+std::string bandCurvePathFor(const std::string &audioPath, bool csv){
+    std::string name = audioPath;
+    size_t slash = name.find_last_of('/');
+    size_t dot = name.find_last_of('.');
+    if(dot != std::string::npos && (slash == std::string::npos || dot > slash))name = name.substr(0, dot);
+    return name + (csv ? ".csv" : ".bands");
+}
+
+bool writeBandCurves(const std::string &path, int sampleRate, int hop, const std::vector<bandCurveFrame> &frames){
+    FILE *fp = fopen(path.c_str(), "wb");
+    if(fp == NULL)return false;
+
+    bandCurveHeader header;
+    memcpy(header.magic, "GBND", 4);
+    header.version = BAND_CURVE_VERSION;
+    header.sampleRate = sampleRate;
+    header.hop = hop;
+    header.bandNum = BAND_NUM;
+    header.frameCount = frames.size();
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    if(ok && !frames.empty())ok = fwrite(&frames[0], sizeof(bandCurveFrame), frames.size(), fp) == frames.size();
+    return fclose(fp) == 0 && ok;
+}
+
+bool writeBandCurvesCsv(const std::string &path, int sampleRate, int hop, const std::vector<bandCurveFrame> &frames){
+    FILE *fp = fopen(path.c_str(), "w");
+    if(fp == NULL)return false;
+
+    fprintf(fp, "time");
+    for(int i=0;i<BAND_NUM;i++)fprintf(fp, ",val%d", i);
+    for(int i=0;i<BAND_NUM;i++)fprintf(fp, ",onset%d", i);
+    fprintf(fp, "\n");
+    for(size_t n=0;n<frames.size();n++){
+        fprintf(fp, "%.6f", n * (double)hop / sampleRate);
+        for(int i=0;i<BAND_NUM;i++)fprintf(fp, ",%.5f", frames[n].val[i]);
+        for(int i=0;i<BAND_NUM;i++)fprintf(fp, ",%d", (frames[n].onsets >> i) & 1);
+        fprintf(fp, "\n");
+    }
+    return fclose(fp) == 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "fft.h"
+
+/*
+ bandCurveFile
+
+ Pre-analyzed band curves, one frame per analysis block:
+
+   header  "GBND", version, sampleRate, hop, bandNum, frameCount   (6 x 4 bytes)
+   frames  float val[BAND_NUM], uint32 onset bits                   (20 bytes each)
+
+ Frame n starts at n * hop / sampleRate seconds. Every field is 4 bytes
+ wide, so the file can be mapped straight into memory and indexed.
+ */
+
+#define BAND_CURVE_VERSION 1
+
+struct bandCurveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t sampleRate;
+    uint32_t hop;
+    uint32_t bandNum;
+    uint32_t frameCount;
+};
+
+struct bandCurveFrame {
+    float val[BAND_NUM];
+    uint32_t onsets;        // bit i set = onset in band i
+};
+
+/*
+ bandCurveMap
+
+ Read-only memory mapping of a .bands file for show playback: looking up
+ the frame for a playback position is an index into the mapped file.
+ */
+
+class bandCurveMap {
+
+public:
+    bandCurveMap();
+    ~bandCurveMap();
+
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const;
+
+    const bandCurveFrame * frameAt(double seconds) const;
+    double duration() const;
+
+    const bandCurveHeader * header;
+    const bandCurveFrame * frames;
+    std::string error;
+
+private:
+    void * data;
+    size_t size;
+};
+
+/* "track.wav" -> "track.bands" (or "track.csv") */
+std::string bandCurvePathFor(const std::string &audioPath, bool csv = false);
+
+bool writeBandCurves(const std::string &path, int sampleRate, int hop, const std::vector<bandCurveFrame> &frames);
+bool writeBandCurvesCsv(const std::string &path, int sampleRate, int hop, const std::vector<bandCurveFrame> &frames);
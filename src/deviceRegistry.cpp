@@ -0,0 +1,200 @@
+#include "deviceRegistry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sstream>
+
+/* the leanLed frame has no pin numbers: the sketch's pin table decides where each channel goes */
+static bool isSketchPins(const vector<int> &pins){
+    static const int sketch[LEAN_SKETCH_CHANNELS] = LEAN_SKETCH_PINS;
+    if(pins.size() != LEAN_SKETCH_CHANNELS)return false;
+    for(int i=0;i<LEAN_SKETCH_CHANNELS;i++)if(pins[i] != sketch[i])return false;
+    return true;
+}
+
+deviceRegistry::deviceRegistry(){
+}
+
+deviceRegistry::~deviceRegistry(){
+    close();
+    for(size_t i=0;i<devices.size();i++){
+        delete devices[i].output;
+        delete devices[i].mock;
+    }
+}
+
+bool deviceRegistry::load(const string &path){
+    FILE *fp = fopen(path.c_str(), "r");
+    if(fp == NULL){
+        error = "can't open " + path;
+        return false;
+    }
+    // parse everything first: a bad line must not leave the lines before it registered
+    vector<device> loaded;
+    char line[1024];
+    int lineNumber = 0;
+    bool ok = true;
+    while(ok && fgets(line, sizeof(line), fp) != NULL){
+        lineNumber++;
+        char *hash = strchr(line, '#');
+        if(hash != NULL)*hash = 0;
+        std::istringstream in(line);
+        string port, protocol;
+        int baud;
+        if(!(in >> port))continue;      // blank or comment
+        if(!(in >> baud >> protocol) || (protocol != "firmata" && protocol != "lean")){
+            error = path + ":" + ofToString(lineNumber) + ": expected PORT BAUD firmata|lean PIN...";
+            ok = false;
+            break;
+        }
+        vector<int> pins;
+        string token;
+        while(ok && in >> token){
+            char *end;
+            long p = strtol(token.c_str(), &end, 10);
+            if(*end != 0 || end == token.c_str()){
+                error = path + ":" + ofToString(lineNumber) + ": '" + token + "' is not a pin number";
+                ok = false;
+            }
+            pins.push_back(p);
+        }
+        if(ok && protocol == "lean" && !isSketchPins(pins)){
+            error = path + ":" + ofToString(lineNumber) + ": a lean board drives the pins in goisLeanLed's pins[], "
+                    + "list exactly those (LEAN_SKETCH_PINS in leanLed.h)";
+            ok = false;
+        }
+        if(ok){
+            device d;
+            d.port = port;
+            d.baud = baud;
+            d.lean = protocol == "lean";
+            d.pins = pins;
+            d.output = NULL;
+            d.mock = NULL;
+            loaded.push_back(d);
+        }
+    }
+    fclose(fp);
+    if(ok && loaded.empty()){
+        error = path + " lists no devices";
+        ok = false;
+    }
+    if(!ok)return false;
+    for(size_t i=0;i<loaded.size();i++)addDevice(loaded[i].port, loaded[i].baud, loaded[i].lean, loaded[i].pins);
+    return true;
+}
+
+void deviceRegistry::addDevice(const string &port, int baud, bool lean, const vector<int> &pins){
+    device d;
+    d.port = port;
+    d.baud = baud;
+    d.lean = lean;
+    d.output = new serialOutput();
+    d.mock = NULL;
+    if(lean && !isSketchPins(pins))ofLogWarning() << port << ": pins differ from goisLeanLed's (LEAN_SKETCH_PINS), the board will drop its frames";
+    for(size_t i=0;i<pins.size()&&channels.size()<MAX_CHANNELS;i++){
+        if(lean && d.pins.size() == LEAN_MAX_CHANNELS){
+            ofLogWarning() << port << ": a lean board takes at most " << LEAN_MAX_CHANNELS << " pins, the rest are skipped";
+            break;
+        }
+        if(pins[i] < 0 || pins[i] >= SHADOW_PINS){
+            ofLogWarning() << port << ": pin " << pins[i] << " out of range, skipped";
+            continue;
+        }
+        d.pins.push_back(pins[i]);
+        route r;
+        r.device = devices.size();
+        r.pin = pins[i];
+        channels.push_back(r);
+    }
+    if(!d.pins.empty())d.output->setChannels(&d.pins[0], d.pins.size());
+    devices.push_back(d);
+}
+
+void deviceRegistry::connect(float rate, bool mock, const string &mockLog){
+    for(size_t i=0;i<devices.size();i++){
+        device &d = devices[i];
+        string port = d.port;
+        if(mock){
+            d.mock = new mockArduino();
+            string log = mockLog.empty() || devices.size() == 1 ? mockLog : mockLog + "." + ofToString(i);
+            if(d.mock->setup(d.baud, d.lean, log, d.output))port = d.mock->devicePath();
+            else ofLogError() << d.mock->error;
+        }
+        d.output->connect(port, d.baud, rate, d.lean);
+    }
+}
+
+void deviceRegistry::close(){
+    for(size_t i=0;i<devices.size();i++){
+        if(devices[i].output->isThreadRunning())devices[i].output->waitForThread(true);
+        if(devices[i].mock && devices[i].mock->isThreadRunning())devices[i].mock->waitForThread(true);
+    }
+}
+
+int deviceRegistry::numChannels() const{
+    return channels.size();
+}
+
+int deviceRegistry::numDevices() const{
+    return devices.size();
+}
+
+//--------------------------------------------------------------
+bool deviceRegistry::pinMode(int channel, int mode){
+    if(channel < 0 || channel >= (int)channels.size())return false;
+    const route &r = channels[channel];
+    return devices[r.device].output->pinMode(r.pin, mode);
+}
+
+bool deviceRegistry::digital(int channel, int value){
+    if(channel < 0 || channel >= (int)channels.size())return false;
+    const route &r = channels[channel];
+    return devices[r.device].output->digital(r.pin, value);
+}
+
+bool deviceRegistry::pwm(int channel, int value){
+    if(channel < 0 || channel >= (int)channels.size())return false;
+    const route &r = channels[channel];
+    return devices[r.device].output->pwm(r.pin, value);
+}
+
+void deviceRegistry::commit(uint64_t micros, uint64_t traceId){
+    for(size_t i=0;i<devices.size();i++)devices[i].output->commit(micros, traceId);
+}
+
+//--------------------------------------------------------------
+uint64_t deviceRegistry::bytes() const{
+    uint64_t n = 0;
+    for(size_t i=0;i<devices.size();i++)n += devices[i].output->bytes;
+    return n;
+}
+
+uint64_t deviceRegistry::messages() const{
+    uint64_t n = 0;
+    for(size_t i=0;i<devices.size();i++)n += devices[i].output->messages;
+    return n;
+}
+
+uint64_t deviceRegistry::suppressed() const{
+    uint64_t n = 0;
+    for(size_t i=0;i<devices.size();i++)n += devices[i].output->requested.suppressed.load(std::memory_order_relaxed);
+    return n;
+}
+
+uint64_t deviceRegistry::coalesced() const{
+    uint64_t n = 0;
+    for(size_t i=0;i<devices.size();i++)n += devices[i].output->coalesced;
+    return n;
+}
+
+void deviceRegistry::resetMockStats(){
+    for(size_t i=0;i<devices.size();i++)if(devices[i].mock)devices[i].mock->resetStats();
+}
+
+void deviceRegistry::printMockStats(const string &label){
+    for(size_t i=0;i<devices.size();i++){
+        if(!devices[i].mock)continue;
+        devices[i].mock->printStats(devices.size() == 1 ? label : label + " #" + ofToString(i));
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ofMain.h"
+#include "serialOutput.h"
+#include "mockArduino.h"
+
+#define MAX_CHANNELS 256
+
+/*
+ deviceRegistry
+
+ Maps logical LED channels onto (device, pin) pairs. Every device is one
+ serial board with its own serialOutput, so each board is written by its
+ own thread and a commit() fans the frame out to all of them in parallel.
+ Channels are numbered in device order: the first device's pins are
+ channels 0..n-1, the next device continues from n, and so on.
+
+ Devices come from a text file, one per line:
+
+   # port             baud    protocol  pins
+   /dev/ttyACM0       57600   firmata   3 5 6 9
+   /dev/ttyUSB0       115200  lean      3 5 6 9
+
+ A lean board runs arduino/goisLeanLed, whose pin table decides where
+ each channel goes: its line must list exactly that table
+ (LEAN_SKETCH_PINS), in order.
+ */
+
+class deviceRegistry {
+
+public:
+    deviceRegistry();
+    ~deviceRegistry();
+
+    bool load(const string &path);
+    void addDevice(const string &port, int baud, bool lean, const vector<int> &pins);
+    /* start one output thread per device; with `mock` every device gets a mockArduino instead of its port */
+    void connect(float rate, bool mock, const string &mockLog);
+    void close();
+
+    int numChannels() const;
+    int numDevices() const;
+
+    /* ledScheduler (its thread, or the main thread when ticked per frame): route a channel write to its device, false if nothing changes */
+    bool pinMode(int channel, int mode);
+    bool digital(int channel, int value);
+    bool pwm(int channel, int value);
+    void commit(uint64_t micros, uint64_t traceId = UINT64_MAX);
+
+    /* totals over all devices */
+    uint64_t bytes() const;
+    uint64_t messages() const;
+    uint64_t suppressed() const;
+    uint64_t coalesced() const;
+
+    void resetMockStats();
+    void printMockStats(const string &label);
+
+    string error;
+
+private:
+    struct device {
+        string port;
+        int baud;
+        bool lean;
+        vector<int> pins;
+        serialOutput *output;
+        mockArduino *mock;
+    };
+    struct route {
+        int device;
+        int pin;
+    };
+
+    vector<device> devices;
+    vector<route> channels;
+};
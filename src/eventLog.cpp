@@ -0,0 +1,202 @@
+#include "eventLog.h"
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct eventFileHeader {
+    char magic[4];          // "GEVT"
+    uint32_t version;
+    uint64_t reserved;
+};
+
+static size_t align8(size_t n){
+    return (n + 7) & ~(size_t)7;
+}
+
+static bool preallocate(int fd, size_t size){
+#ifdef __APPLE__
+    fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)size, 0};
+    if(fcntl(fd, F_PREALLOCATE, &store) == 0)return true;
+    store.fst_flags = F_ALLOCATEALL;
+    return fcntl(fd, F_PREALLOCATE, &store) == 0;
+#else
+    int r = posix_fallocate(fd, 0, size);
+    // filesystems without fallocate still work, the prefault thread covers them
+    return r == 0 || r == EINVAL || r == EOPNOTSUPP;
+#endif
+}
+
+eventLog::eventLog(){
+    fd = -1;
+    writable = false;
+    base = NULL;
+    capacity = 0;
+    used = 0;
+    readPos = 0;
+    dropped = 0;
+}
+
+eventLog::~eventLog(){
+    close();
+}
+
+bool eventLog::create(const std::string &path, size_t size){
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0){
+        error = "can't create " + path;
+        return false;
+    }
+    // the file is cut back to the used length on close()
+    if(ftruncate(fd, size) != 0){
+        error = "can't size " + path;
+        close();
+        return false;
+    }
+    // allocate the blocks now, not from the audio thread's first write to each page
+    if(!preallocate(fd, size)){
+        error = "not enough space for " + path;
+        close();
+        return false;
+    }
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED){
+        error = "can't map " + path;
+        close();
+        return false;
+    }
+    base = (char *)p;
+    capacity = size;
+    writable = true;
+
+    eventFileHeader *h = (eventFileHeader *)base;
+    memcpy(h->magic, "GEVT", 4);
+    h->version = EVENT_LOG_VERSION;
+    h->reserved = 0;
+    used = sizeof(eventFileHeader);
+    startThread();
+    return true;
+}
+
+void eventLog::threadedFunction(){
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t touched = 0;
+    while(isThreadRunning()){
+        size_t target = used + EVENT_LOG_PREFAULT;
+        if(target > capacity)target = capacity;
+        for(;touched<target;touched+=page){
+            // an atomic add of 0 faults the page in writable without clobbering a record written concurrently
+            __atomic_fetch_add(base + touched, 0, __ATOMIC_RELAXED);
+        }
+        sleep(10);
+    }
+}
+
+bool eventLog::isRecording() const{
+    return writable;
+}
+
+bool eventLog::append(uint32_t type, uint64_t micros, const void *head, uint32_t headSize, const void *body, uint32_t bodySize){
+    if(!writable)return false;
+    size_t size = headSize + bodySize;
+    size_t total = sizeof(eventHeader) + align8(size);
+    size_t pos = used.fetch_add(total, std::memory_order_relaxed);
+    if(pos + total > capacity){
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    eventHeader *h = (eventHeader *)(base + pos);
+    h->type = type;
+    h->size = size;
+    h->micros = micros;
+    char *p = (char *)(h + 1);
+    if(headSize)memcpy(p, head, headSize);
+    if(bodySize)memcpy(p + headSize, body, bodySize);
+    return true;
+}
+
+void eventLog::logAudio(uint64_t micros, const float *input, int bufferSize, int nChannels){
+    eventAudio a;
+    a.bufferSize = bufferSize;
+    a.nChannels = nChannels;
+    append(EVENT_AUDIO, micros, &a, sizeof(a), input, bufferSize * nChannels * sizeof(float));
+}
+
+void eventLog::logInput(uint32_t type, uint64_t micros, int key, int x, int y, bool pressed){
+    eventInput e;
+    e.key = key;
+    e.x = x;
+    e.y = y;
+    e.pressed = pressed;
+    append(type, micros, &e, sizeof(e));
+}
+
+void eventLog::logFirmata(uint64_t micros, int command, int pin, int value){
+    eventFirmata e;
+    e.command = command;
+    e.pin = pin;
+    e.value = value;
+    append(EVENT_FIRMATA, micros, &e, sizeof(e));
+}
+
+bool eventLog::open(const std::string &path){
+    close();
+    fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if(fd < 0 || fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(eventFileHeader)){
+        error = "can't open " + path;
+        close();
+        return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(p == MAP_FAILED){
+        error = "can't map " + path;
+        close();
+        return false;
+    }
+    base = (char *)p;
+    capacity = st.st_size;
+    const eventFileHeader *h = (const eventFileHeader *)base;
+    if(memcmp(h->magic, "GEVT", 4) != 0 || h->version != EVENT_LOG_VERSION){
+        error = path + " is not an event log";
+        close();
+        return false;
+    }
+    used = capacity;
+    readPos = sizeof(eventFileHeader);
+    return true;
+}
+
+const eventHeader * eventLog::next(){
+    if(base == NULL || writable || readPos + sizeof(eventHeader) > capacity)return NULL;
+    const eventHeader *h = (const eventHeader *)(base + readPos);
+    size_t total = sizeof(eventHeader) + align8(h->size);
+    if(h->type == 0 || readPos + total > capacity)return NULL;
+    readPos += total;
+    return h;
+}
+
+const void * eventLog::payload(const eventHeader *h) const{
+    return h + 1;
+}
+
+void eventLog::close(){
+    if(isThreadRunning())waitForThread(true);
+    size_t length = used;
+    if(base != NULL)munmap(base, capacity);
+    if(fd >= 0){
+        if(writable && ftruncate(fd, length < capacity ? length : capacity) != 0){
+            error = "can't trim log";
+        }
+        ::close(fd);
+    }
+    fd = -1;
+    writable = false;
+    base = NULL;
+    capacity = 0;
+    used = 0;
+    readPos = 0;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+#include "ofMain.h"
+
+/*
+ eventLog
+
+ Memory-mapped, append-only log of everything that goes into and comes
+ out of the app: audio blocks, OSC in/out, key and mouse events, Firmata
+ writes and frame boundaries, each with a timestamp. Appends reserve space
+ with a single atomic add and copy into the mapping, so the audio thread
+ can log without locks or allocation. When the preallocated space runs out
+ further events are dropped and counted.
+
+ The audio thread must not pay for page faults either: create() reserves
+ the file's blocks up front (posix_fallocate / F_PREALLOCATE), and while
+ recording a background thread touches the mapping's pages
+ EVENT_LOG_PREFAULT bytes ahead of the write position, so appends land on
+ pages that are already mapped.
+
+ Layout: 16 byte file header, then records of
+   eventHeader (16 bytes) + payload, padded to 8 bytes.
+ */
+
+#define EVENT_LOG_VERSION 2      // 2: EVENT_LED_TICK
+#define EVENT_LOG_PREFAULT (32 << 20)
+
+enum eventType {
+    EVENT_FRAME = 1,        // start of ofApp::update(), no payload
+    EVENT_AUDIO,            // eventAudio + interleaved float samples
+    EVENT_OSC_IN,           // OSC packet bytes
+    EVENT_OSC_OUT,          // OSC packet bytes
+    EVENT_KEY,              // eventInput
+    EVENT_MOUSE,            // eventInput
+    EVENT_FIRMATA,          // eventFirmata
+    EVENT_LED_TICK          // ledScheduler::tick() ran for this time, no payload
+};
+
+struct eventHeader {
+    uint32_t type;
+    uint32_t size;          // payload bytes, without padding
+    uint64_t micros;
+};
+
+struct eventAudio {
+    int32_t bufferSize;
+    int32_t nChannels;
+};
+
+struct eventInput {
+    int32_t key;            // key code or mouse button
+    int32_t x, y;
+    int32_t pressed;
+};
+
+enum firmataCommand {
+    FIRMATA_PIN_MODE,
+    FIRMATA_DIGITAL,
+    FIRMATA_PWM
+};
+
+struct eventFirmata {
+    int32_t command;
+    int32_t pin;        // logical LED channel, see deviceRegistry
+    int32_t value;
+};
+
+class eventLog : public ofThread {
+
+public:
+    eventLog();
+    ~eventLog();
+
+    /* record */
+    bool create(const std::string &path, size_t capacity);
+    bool isRecording() const;
+    bool append(uint32_t type, uint64_t micros, const void *head, uint32_t headSize, const void *body = NULL, uint32_t bodySize = 0);
+    void logAudio(uint64_t micros, const float *input, int bufferSize, int nChannels);
+    void logInput(uint32_t type, uint64_t micros, int key, int x, int y, bool pressed);
+    void logFirmata(uint64_t micros, int command, int pin, int value);
+
+    /* replay */
+    bool open(const std::string &path);
+    const eventHeader * next();
+    const void * payload(const eventHeader *h) const;
+
+    void close();
+
+    std::atomic<uint64_t> dropped;
+    std::string error;
+
+protected:
+    void threadedFunction();    // prefaults pages ahead of `used`
+
+private:
+    int fd;
+    bool writable;
+    char *base;
+    size_t capacity;
+    std::atomic<size_t> used;
+    size_t readPos;
+};
@@ -398,7 +398,15 @@ void WindowFunc(int whichFunction, int NumSamples, float *in)
 
 /* constructor */
 fft::fft() {
-    
+    for(int i=0;i<BAND_NUM;i++){
+        lmh_length[i]=map_min[i]=map_max[i]=band_bottom[i]=band_top[i]=val[i]=0;
+        map_newMin[i]=map_newMax[i]=pre_ave[i]=pre_val[i]=vol_max[i]=0;
+        bCut[i]=false;
+    }
+    temp_val=0;
+    bSmooth=bSelectPreset=bReset=bAutoMaxGet=false;
+    preset_index=0;
+    smoothRate=rate=0;
 }
 
 /* destructor */
@@ -548,7 +556,18 @@ void fft::changeBandRange(int key){
     else if(key=='j')band_bottom[3]--;
     else if(key=='i')band_top[3]++;
     else if(key=='k')band_top[3]--;
+    updateBandRange();
+}
+
+/* keep every band inside the spectrum and at least one bin wide */
+void fft::updateBandRange(){
     for(int i=0;i<BAND_NUM;i++){
+        band_bottom[i] = (int)band_bottom[i];
+        band_top[i] = (int)band_top[i];
+        if(band_bottom[i]<0)band_bottom[i]=0;
+        if(band_bottom[i]>FFT_BINS-1)band_bottom[i]=FFT_BINS-1;
+        if(band_top[i]<band_bottom[i]+1)band_top[i]=band_bottom[i]+1;
+        if(band_top[i]>FFT_BINS)band_top[i]=FFT_BINS;
         lmh_length[i] = band_top[i] - band_bottom[i];
     }
 }
@@ -589,3 +608,32 @@ void fft::changeParam(int key){
     else if(key==',')map_max[3]-=rate;
     
 }
+
+void fft::getParams(fftParams &p) const{
+    for(int i=0;i<BAND_NUM;i++){
+        p.band_bottom[i]=band_bottom[i];
+        p.band_top[i]=band_top[i];
+        p.map_min[i]=map_min[i];
+        p.map_max[i]=map_max[i];
+        p.map_newMin[i]=map_newMin[i];
+        p.map_newMax[i]=map_newMax[i];
+    }
+    p.smoothRate=smoothRate;
+    p.bSmooth=bSmooth;
+    p.bAutoMaxGet=bAutoMaxGet;
+}
+
+void fft::setParams(const fftParams &p){
+    for(int i=0;i<BAND_NUM;i++){
+        band_bottom[i]=p.band_bottom[i];
+        band_top[i]=p.band_top[i];
+        map_min[i]=p.map_min[i];
+        map_max[i]=p.map_max[i];
+        map_newMin[i]=p.map_newMin[i];
+        map_newMax[i]=p.map_newMax[i];
+    }
+    smoothRate=p.smoothRate;
+    bSmooth=p.bSmooth;
+    bAutoMaxGet=p.bAutoMaxGet;
+    updateBandRange();
+}
@@ -7,7 +7,14 @@
 #endif
 
 #define BAND_NUM 4
+#define FFT_BINS 128     // BUFFER_SIZE/2 magnitudes per block
 
+/* the tunable part of fft: what the keys and OSC change, see getParams/setParams */
+struct fftParams {
+    float band_bottom[BAND_NUM],band_top[BAND_NUM],map_min[BAND_NUM],map_max[BAND_NUM],map_newMin[BAND_NUM],map_newMax[BAND_NUM];
+    float smoothRate;
+    bool bSmooth,bAutoMaxGet;
+};
 
 class fft {
 	
@@ -31,7 +38,10 @@ class fft {
     void update(float *magni,int i);
     void setup();
     void changeBandRange(int key);
+    void updateBandRange();
     void changeParam(int key);
+    void getParams(fftParams &p) const;
+    void setParams(const fftParams &p);     // band ranges are clamped as in updateBandRange
     
 };
 
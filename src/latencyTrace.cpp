@@ -0,0 +1,134 @@
+#include "latencyTrace.h"
+
+#ifdef GOIS_TRACE
+
+#include <chrono>
+#include <stdio.h>
+
+latencyTrace gTrace;
+
+static const char * stageNames[TRACE_STAGE_NUM] = {"capture", "analysis", "led mapping", "osc mapping", "osc send", "serial handoff", "serial write"};
+
+/*-------------------latencyHistogram-------------------*/
+latencyHistogram::latencyHistogram(){
+    for(int i=0;i<BUCKETS;i++)buckets[i] = 0;
+    total = 0;
+    maxValue = 0;
+}
+
+int latencyHistogram::bucketOf(uint64_t v){
+    if(v < SUB)return (int)v;
+    int e = 63 - __builtin_clzll(v);                    // v is in [2^e, 2^(e+1))
+    int b = (e - SUB_BITS + 1) * SUB + (int)((v >> (e - SUB_BITS)) & (SUB - 1));
+    return b < BUCKETS ? b : BUCKETS - 1;
+}
+
+uint64_t latencyHistogram::valueOf(int bucket){
+    if(bucket < SUB)return bucket;
+    int e = bucket / SUB + SUB_BITS - 1;
+    uint64_t sub = bucket % SUB;
+    return (((uint64_t)SUB + sub) << (e - SUB_BITS)) + ((uint64_t)1 << (e - SUB_BITS)) / 2;    // bucket midpoint
+}
+
+void latencyHistogram::record(uint64_t micros){
+    buckets[bucketOf(micros)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    uint64_t m = maxValue.load(std::memory_order_relaxed);
+    while(micros > m && !maxValue.compare_exchange_weak(m, micros, std::memory_order_relaxed));
+}
+
+uint64_t latencyHistogram::percentile(double p) const{
+    uint64_t n = total.load(std::memory_order_relaxed);
+    if(n == 0)return 0;
+    uint64_t target = (uint64_t)(p / 100.0 * n + 0.5);
+    if(target < 1)target = 1;
+    uint64_t seen = 0;
+    for(int i=0;i<BUCKETS;i++){
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if(seen >= target)return valueOf(i);
+    }
+    return max();
+}
+
+uint64_t latencyHistogram::count() const{
+    return total.load(std::memory_order_relaxed);
+}
+
+uint64_t latencyHistogram::max() const{
+    return maxValue.load(std::memory_order_relaxed);
+}
+
+/*-------------------latencyTrace-------------------*/
+latencyTrace::latencyTrace(){
+    for(int i=0;i<CAPTURES;i++){
+        captures[i].id = UINT64_MAX;
+        captures[i].micros = 0;
+    }
+    for(int i=0;i<TRACE_STAGE_NUM;i++)lastId[i] = UINT64_MAX;
+    eventCount = 0;
+}
+
+uint64_t latencyTrace::now(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void latencyTrace::begin(uint64_t id){
+    capture &c = captures[id % CAPTURES];
+    c.micros.store(now(), std::memory_order_relaxed);
+    c.id.store(id, std::memory_order_release);
+    stage(id, TRACE_CAPTURE);
+}
+
+void latencyTrace::stage(uint64_t id, traceStage s){
+    if(id == UINT64_MAX)return;     // no block behind this value (show mode, nothing analyzed yet)
+    // a result is reused until the next one arrives: only its first arrival at a stage counts
+    uint64_t last = lastId[s].load(std::memory_order_relaxed);
+    do{
+        if(last != UINT64_MAX && id <= last)return;
+    }while(!lastId[s].compare_exchange_weak(last, id, std::memory_order_relaxed));
+
+    const capture &c = captures[id % CAPTURES];
+    if(c.id.load(std::memory_order_acquire) != id)return;      // too old, slot reused
+    uint64_t start = c.micros.load(std::memory_order_relaxed);
+    uint64_t t = now();
+    uint64_t latency = t > start ? t - start : 0;
+    histograms[s].record(latency);
+
+    event &e = events[eventCount.fetch_add(1, std::memory_order_relaxed) % EVENTS];
+    e.id = id;
+    e.start = start;
+    e.duration = (uint32_t)latency;
+    e.stage = s;
+}
+
+void latencyTrace::printSummary() const{
+    printf("latency since capture (us)     count      p50      p90      p99      max\n");
+    for(int i=0;i<TRACE_STAGE_NUM;i++){
+        const latencyHistogram &h = histograms[i];
+        printf("  %-14s %16llu %8llu %8llu %8llu %8llu\n", stageNames[i],
+               (unsigned long long)h.count(), (unsigned long long)h.percentile(50),
+               (unsigned long long)h.percentile(90), (unsigned long long)h.percentile(99),
+               (unsigned long long)h.max());
+    }
+}
+
+bool latencyTrace::writeChromeTrace(const std::string &path) const{
+    FILE *fp = fopen(path.c_str(), "w");
+    if(fp == NULL)return false;
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for(int i=0;i<TRACE_STAGE_NUM;i++){
+        fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", i, stageNames[i]);
+    }
+    // one span per block and stage: from capture until the block reached that stage
+    uint64_t n = eventCount.load(std::memory_order_acquire);
+    uint64_t first = n > EVENTS ? n - EVENTS : 0;
+    for(uint64_t i=first;i<n;i++){
+        const event &e = events[i % EVENTS];
+        fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%u,\"args\":{\"block\":%llu}},\n",
+                stageNames[e.stage], e.stage, (unsigned long long)e.start, e.duration, (unsigned long long)e.id);
+    }
+    fprintf(fp, "{\"name\":\"end\",\"ph\":\"i\",\"pid\":1,\"tid\":0,\"ts\":0,\"s\":\"g\"}\n]}\n");
+    return fclose(fp) == 0;
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+/*
+ latencyTrace
+
+ Per-block latency tracing from audio capture to output. Each audio block
+ is traced under its audioBlock::seq; every stage it reaches records the
+ time since capture into an HDR-style log-linear histogram (16 buckets
+ per power of two, ~6% resolution) and into a ring of recent events that
+ can be written out as Chrome trace JSON (chrome://tracing, Perfetto).
+
+ A stage keeps the last id it counted so a reused result is only measured
+ once. Each stage is therefore stamped by one path only, or two paths
+ would hide each other; the exception is TRACE_SERIAL_WRITE, where every
+ board's serial thread races to stamp and the first write on the wire
+ wins (the id is claimed atomically).
+
+ Tracing is off unless the project is built with GOIS_TRACE defined
+ (PROJECT_DEFINES = GOIS_TRACE in config.make, or -DGOIS_TRACE in Xcode's
+ Other C++ Flags). Without it the TRACE_* macros expand to nothing and
+ their arguments are never evaluated.
+ */
+
+enum traceStage {
+    TRACE_CAPTURE,          // block pushed by audioReceived
+    TRACE_ANALYSIS,         // FFT + band update done
+    TRACE_MAPPING_LED,      // band values mapped to LED levels (ledScheduler)
+    TRACE_MAPPING_OSC,      // band values mapped into the OSC bundle (main thread)
+    TRACE_OSC_SEND,         // /vol handed to the socket
+    TRACE_SERIAL_HANDOFF,   // LED frame committed to the serial threads, not yet on the wire
+    TRACE_SERIAL_WRITE,     // first board's write() of that frame returned (serialOutput)
+    TRACE_STAGE_NUM
+};
+
+#ifdef GOIS_TRACE
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+class latencyHistogram {
+
+public:
+    enum { SUB_BITS = 4, SUB = 1 << SUB_BITS, BUCKETS = (40 - SUB_BITS + 1) * SUB };
+
+    latencyHistogram();
+    void record(uint64_t micros);
+    uint64_t percentile(double p) const;
+    uint64_t count() const;
+    uint64_t max() const;
+
+private:
+    static int bucketOf(uint64_t v);
+    static uint64_t valueOf(int bucket);
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maxValue;
+};
+
+class latencyTrace {
+
+public:
+    latencyTrace();
+
+    void begin(uint64_t id);
+    void stage(uint64_t id, traceStage s);
+
+    void printSummary() const;
+    bool writeChromeTrace(const std::string &path) const;
+
+    latencyHistogram histograms[TRACE_STAGE_NUM];
+
+private:
+    enum { CAPTURES = 1024, EVENTS = 1 << 16 };
+
+    struct capture {
+        std::atomic<uint64_t> id;
+        std::atomic<uint64_t> micros;
+    };
+    struct event {
+        uint64_t id;
+        uint64_t start;
+        uint32_t duration;
+        uint32_t stage;
+    };
+
+    static uint64_t now();
+
+    capture captures[CAPTURES];
+    std::atomic<uint64_t> lastId[TRACE_STAGE_NUM];
+    event events[EVENTS];
+    std::atomic<uint64_t> eventCount;
+};
+
+extern latencyTrace gTrace;
+
+#define TRACE_BEGIN(id)             gTrace.begin(id)
+#define TRACE_STAGE(id, s)          gTrace.stage(id, s)
+#define TRACE_DUMP(path)            do{ gTrace.printSummary(); gTrace.writeChromeTrace(path); }while(0)
+
+#else
+
+#define TRACE_BEGIN(id)             ((void)0)
+#define TRACE_STAGE(id, s)          ((void)0)
+#define TRACE_DUMP(path)            ((void)0)
+
+#endif
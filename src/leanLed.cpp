@@ -0,0 +1,67 @@
+#include "leanLed.h"
+#include <string.h>
+
+static uint8_t crcStep(uint8_t crc, uint8_t b){
+    crc ^= b;
+    for(int i=0;i<8;i++)crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    return crc;
+}
+
+uint8_t leanCrc8(const uint8_t *data, int size){
+    uint8_t crc = 0;
+    for(int i=0;i<size;i++)crc = crcStep(crc, data[i]);
+    return crc;
+}
+
+int encodeLeanFrame(const uint8_t *values, int count, uint8_t *out){
+    if(count > LEAN_MAX_CHANNELS)count = LEAN_MAX_CHANNELS;
+    out[0] = LEAN_SYNC;
+    out[1] = count;
+    memcpy(out + 2, values, count);
+    out[count + 2] = leanCrc8(out + 1, count + 1);
+    return count + 3;
+}
+
+//--------------------------------------------------------------
+leanLedDecoder::leanLedDecoder(){
+    state = WAIT_SYNC;
+    count = 0;
+    frames = 0;
+    crcErrors = 0;
+    expected = received = 0;
+}
+
+bool leanLedDecoder::feed(uint8_t b){
+    switch(state){
+        case WAIT_SYNC:
+            if(b == LEAN_SYNC)state = LENGTH;
+            return false;
+        case LENGTH:
+            if(b == 0 || b > LEAN_MAX_CHANNELS){
+                state = b == LEAN_SYNC ? LENGTH : WAIT_SYNC;
+                return false;
+            }
+            expected = b;
+            received = 0;
+            state = DATA;
+            return false;
+        case DATA:
+            buf[received++] = b;
+            if(received == expected)state = CRC;
+            return false;
+        case CRC:{
+            state = WAIT_SYNC;
+            uint8_t crc = crcStep(0, expected);
+            for(int i=0;i<expected;i++)crc = crcStep(crc, buf[i]);
+            if(crc != b){
+                crcErrors++;
+                return false;
+            }
+            memcpy(values, buf, expected);
+            count = expected;
+            frames++;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+#define LEAN_SYNC 0xA5
+#define LEAN_MAX_CHANNELS 250
+
+/* what arduino/goisLeanLed drives: channel i -> pin i of this list. Change both together. */
+#define LEAN_SKETCH_CHANNELS 4
+#define LEAN_SKETCH_PINS {3, 5, 6, 9}
+
+/*
+ leanLed
+
+ Compact alternative to Firmata for driving LED channels, one frame
+ carries every channel at once:
+
+   0xA5  N  v0 v1 .. vN-1  crc
+
+ N is the channel count, each v a 0-255 brightness, crc a CRC-8
+ (polynomial 0x07, init 0) over N and the values. 4 channels cost 7
+ bytes per update where Firmata needs 12 plus pin-mode setup. The
+ receiving side is arduino/goisLeanLed/goisLeanLed.ino; leanLedDecoder
+ is the same state machine on the host, for mocks and tests.
+
+ The frame carries no pin numbers, so the host's pin list for a lean
+ board must be the sketch's (LEAN_SKETCH_PINS); deviceRegistry refuses
+ anything else and the sketch drops frames of any other length.
+ */
+
+uint8_t leanCrc8(const uint8_t *data, int size);
+/* returns the frame size (count + 3), out needs room for that */
+int encodeLeanFrame(const uint8_t *values, int count, uint8_t *out);
+
+class leanLedDecoder {
+
+public:
+    leanLedDecoder();
+
+    /* returns true when `b` completed a valid frame, see values/count */
+    bool feed(uint8_t b);
+
+    uint8_t values[LEAN_MAX_CHANNELS];
+    int count;
+    uint64_t frames, crcErrors;
+
+private:
+    enum { WAIT_SYNC, LENGTH, DATA, CRC } state;
+    uint8_t buf[LEAN_MAX_CHANNELS];
+    int expected, received;
+};
@@ -0,0 +1,39 @@
+#include "ledCurves.h"
+#include <math.h>
+
+ledCurves::ledCurves(){
+    for(int i=0;i<LED_WAVE_SIZE;i++){
+        sine[i] = (uint16_t)lround((0.5 + 0.5 * sin(2 * M_PI * i / LED_WAVE_SIZE)) * LED_FULL);
+    }
+    setup(0, 1, false);
+}
+
+void ledCurves::setup(int channels, float g, bool dither){
+    gamma = g > 0 ? g : 1;
+    bDither = dither;
+    for(int i=0;i<=LED_FULL;i++){
+        linear[i] = (uint16_t)lround(pow(i / (double)LED_FULL, gamma) * 65535);
+    }
+    error.assign(channels, 0);
+}
+
+int ledCurves::toPwm(int channel, int level){
+    if(level <= 0)return 0;
+    if(level >= LED_FULL)return 255;
+    // 16 bit duty scaled onto 0..255*256
+    uint32_t v = linear[level] - (linear[level] >> 8);
+    if(!bDither || channel < 0 || channel >= (int)error.size())return (v + 128) >> 8;
+    v += error[channel];
+    error[channel] = v & 0xff;
+    return v >> 8;
+}
+
+int ledCurves::wave(double seconds, double cycles) const{
+    double turns = seconds * cycles;
+    uint32_t i = (uint32_t)((turns - floor(turns)) * LED_WAVE_SIZE) & (LED_WAVE_SIZE - 1);
+    return sine[i];
+}
+
+void ledCurves::resetDither(){
+    for(size_t i=0;i<error.size();i++)error[i] = 0;
+}
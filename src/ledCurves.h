@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#define LED_FULL 4095           // channel brightness is 12 bit, perceptual
+#define LED_WAVE_SIZE 1024      // one period, power of two
+
+/*
+ ledCurves
+
+ Lookup tables between what the LED modes render and what goes out as
+ PWM. Modes work in perceptual brightness 0..LED_FULL; toPwm() runs that
+ through a gamma table to 16 bit linear duty and quantizes it to the
+ 8-bit PWM value, so equal steps in brightness look equal and fades
+ don't jump at the dark end.
+
+ With dither on, each channel keeps the quantization error and adds it
+ to its next value (first order sigma-delta), so over a few frames the
+ PWM averages out to the 16 bit target: levels between two PWM steps
+ come out as a fine flicker between them instead of a stall. That costs
+ serial writes on every frame a fading channel moves, which the
+ redundant-write skipping can no longer hide.
+
+ wave() is a sine table for ledMode 2, 0..LED_FULL, replacing a
+ per-pin sin() that could reach 256.
+ */
+
+class ledCurves {
+
+public:
+    ledCurves();
+
+    void setup(int channels, float gamma, bool dither);
+
+    /* brightness 0..LED_FULL -> PWM 0..255 for `channel` */
+    int toPwm(int channel, int level);
+    /* sine over 0..LED_FULL, `cycles` periods per second */
+    int wave(double seconds, double cycles) const;
+    void resetDither();
+
+    float gamma;
+    bool bDither;
+
+private:
+    uint16_t linear[LED_FULL + 1];
+    uint16_t sine[LED_WAVE_SIZE];
+    std::vector<uint16_t> error;        // per channel, in 1/256 PWM steps
+};
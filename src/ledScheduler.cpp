@@ -0,0 +1,202 @@
+#include "ledScheduler.h"
+#include "latencyTrace.h"
+#include <unistd.h>
+
+ledScheduler::ledScheduler(){
+    devices = NULL;
+    recorder = NULL;
+    analysis = NULL;
+    rate = 0;
+    ticks = 0;
+    late = 0;
+    pushSeq = 0;
+    mode = 0;
+    scene = 0;
+    bPwm = false;
+    for(int i=0;i<MAX_CHANNELS;i++)value[i] = 0;
+    bandSeq = 0;
+    traceId = UINT64_MAX;
+    for(int i=0;i<BAND_NUM;i++)from[i] = to[i] = 0;
+    arrived = 0;
+    interval = 0;
+    ledControl &c = controls.back();
+    c.mode = 0;
+    c.scene = 0;
+    c.bpm = 0;
+    c.beat = 0;
+    c.beatMicros = 0;
+}
+
+void ledScheduler::setup(deviceRegistry *d, eventLog *log, analysisThread *a, float gamma, bool dither){
+    devices = d;
+    recorder = log;
+    analysis = a;
+    curves.setup(devices->numChannels(), gamma, dither);
+}
+
+void ledScheduler::start(float r){
+    rate = r;
+    startThread();
+}
+
+ledControl & ledScheduler::control(){
+    return controls.back();
+}
+
+void ledScheduler::publish(){
+    // the next back() is a stale slot: carry the current state over so callers only touch what changed
+    ledControl c = controls.back();
+    controls.publish();
+    controls.back() = c;
+}
+
+void ledScheduler::pushBands(const float *val){
+    ledBands &b = pushed.back();
+    b.seq = ++pushSeq;
+    b.traceId = UINT64_MAX;
+    for(int i=0;i<BAND_NUM;i++)b.val[i] = val[i];
+    pushed.publish();
+}
+
+//--------------------------------------------------------------
+void ledScheduler::threadedFunction(){
+    uint64_t period = 1000000 / rate;
+    uint64_t next = ofGetElapsedTimeMicros();
+    while(isThreadRunning()){
+        uint64_t now = ofGetElapsedTimeMicros();
+        if(now > next + period)late++;
+        tick(now);
+        next += period;
+        now = ofGetElapsedTimeMicros();
+        if(next > now)usleep(next - now);
+        else next = now;    // overran: don't try to catch up
+    }
+}
+
+void ledScheduler::tick(uint64_t micros){
+    // a replay ticks exactly here, whichever clock drove the recording
+    if(recorder->isRecording())recorder->append(EVENT_LED_TICK, micros, NULL, 0);
+    const ledControl &c = controls.latest();
+    if(c.scene != scene && c.scene >= 0 && c.scene < sequencer.numPatterns()){
+        scene = c.scene;
+        sequencer.select(scene);
+        // re-enter ledMode 3 so the pin modes match the new pattern
+        if(mode == 3)mode = 0;
+    }
+    if(c.mode != mode)applyMode(c.mode, micros);
+
+    // the main thread only moves the beat once per frame: carry it on to this tick
+    int beat = 0;
+    float phase = 0;
+    if(c.beat > 0 && c.bpm > 0){
+        double period = 60000000.0 / c.bpm;
+        int passed = micros >= c.beatMicros ? 1 + (int)((micros - c.beatMicros) / period) : 0;
+        beat = (c.beat - 1 + passed) % 4 + 1;
+        phase = 1 - (c.beatMicros + passed * period - micros) / period;
+    }
+
+    /*-----------LED 点灯パターン----------*/
+    int n = devices->numChannels();
+    if(mode == 1){
+        if(beat >= 1 && beat <= 4){
+            for(int g=0;g<4;g++)setGroup(g, beat == g + 1 ? LED_FULL : 0);
+        }
+    }else if(mode == 2){
+        // a slow breath, one period every pi seconds
+        int v = curves.wave(micros / 1000000.0, 1 / M_PI);
+        for(int i=0;i<n;i++)value[i] = v;
+    }else if(mode == 3){
+        // phase lets patterns with several steps per beat subdivide it
+        if(beat > 0 && sequencer.advance(beat, phase))sequencer.render(value, n);
+    }else if(mode == 4){
+        renderBands(micros);
+    }
+
+    // only what changed reaches the boards
+    if(bPwm){
+        for(int i=0;i<n;i++)pwm(i, curves.toPwm(i, value[i]), micros);
+    }else if(mode >= 1 && mode <= 4){
+        for(int i=0;i<n;i++)digital(i, value[i] > LED_FULL / 2 ? ARD_HIGH : ARD_LOW, micros);
+    }
+    // the serial threads stamp TRACE_SERIAL_WRITE once the frame is on the wire
+    devices->commit(micros, mode == 4 ? traceId : UINT64_MAX);
+    if(mode == 4)TRACE_STAGE(traceId, TRACE_SERIAL_HANDOFF);
+    ticks++;
+}
+
+void ledScheduler::applyMode(int m, uint64_t micros){
+    mode = m;
+    int n = devices->numChannels();
+    // a sequencer pattern with dimmed steps needs PWM pins
+    bPwm = mode == 2 || mode == 4 || (mode == 3 && sequencer.pattern().bDimmed);
+    if(mode >= 1 && mode <= 4){
+        for(int i=0;i<n;i++)pinMode(i, bPwm ? ARD_PWM : ARD_OUTPUT, micros);
+    }
+    if(mode == 3){
+        for(int i=0;i<n;i++)value[i] = 0;
+        sequencer.reset();
+    }
+    curves.resetDither();
+}
+
+/* the 4-light patterns repeat across all channels: channel i belongs to group i%4 */
+void ledScheduler::setGroup(int group, int v){
+    for(int i=group;i<devices->numChannels();i+=4)value[i] = v;
+}
+
+//--------------------------------------------------------------
+bool ledScheduler::nextBands(ledBands &b){
+    if(analysis == NULL){
+        const ledBands &p = pushed.latest();
+        if(p.seq == 0 || p.seq == bandSeq)return false;
+        b = p;
+        return true;
+    }
+    const analysisResult &r = analysis->latest(READER_LED);
+    if(r.seq == 0 || r.seq == bandSeq)return false;
+    b.seq = r.seq;
+    b.traceId = r.blockSeq;
+    for(int i=0;i<BAND_NUM;i++)b.val[i] = r.val[i];
+    return true;
+}
+
+void ledScheduler::renderBands(uint64_t micros){
+    float level[BAND_NUM];
+    float t = interval > 0 && micros > arrived ? (micros - arrived) / (float)interval : 1;
+    if(t > 1)t = 1;
+    for(int i=0;i<BAND_NUM;i++)level[i] = from[i] + (to[i] - from[i]) * t;
+
+    ledBands b;
+    if(nextBands(b)){
+        // ramp from what is showing now, over the time the last frame took to arrive
+        uint64_t gap = arrived > 0 ? micros - arrived : 0;
+        interval = gap < 100000 ? gap : 100000;
+        arrived = micros;
+        bandSeq = b.seq;
+        traceId = b.traceId;
+        for(int i=0;i<BAND_NUM;i++){
+            from[i] = level[i];
+            to[i] = b.val[i];
+        }
+        TRACE_STAGE(traceId, TRACE_MAPPING_LED);
+    }
+    // bands repeat across the channels
+    int n = devices->numChannels();
+    for(int i=0;i<n;i++)value[i] = ofClamp(ofMap(level[i % BAND_NUM], 0, 2, 0, LED_FULL), 0, LED_FULL);
+}
+
+//--------------------------------------------------------------
+void ledScheduler::pinMode(int channel, int m, uint64_t micros){
+    if(!devices->pinMode(channel, m))return;
+    if(recorder->isRecording())recorder->logFirmata(micros, FIRMATA_PIN_MODE, channel, m);
+}
+
+void ledScheduler::digital(int channel, int v, uint64_t micros){
+    if(!devices->digital(channel, v))return;
+    if(recorder->isRecording())recorder->logFirmata(micros, FIRMATA_DIGITAL, channel, v);
+}
+
+void ledScheduler::pwm(int channel, int v, uint64_t micros){
+    if(!devices->pwm(channel, v))return;
+    if(recorder->isRecording())recorder->logFirmata(micros, FIRMATA_PWM, channel, v);
+}
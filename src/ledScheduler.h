@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ofMain.h"
+#include "fft.h"
+#include "analysisThread.h"
+#include "deviceRegistry.h"
+#include "eventLog.h"
+#include "ledSequencer.h"
+#include "ledCurves.h"
+#include "tripleBuffer.h"
+
+/*
+ ledScheduler
+
+ Renders the LED modes and writes them to the boards on its own clock,
+ so strobe and chase timing doesn't depend on the GL frame rate. The
+ main thread only publishes what it wants (ledControl: mode, scene and
+ its beat clock); every tick the scheduler works out the beat and phase
+ for the tick's own time, renders every channel, writes what changed and
+ commits the frame to all boards stamped with that time.
+
+ Band levels (ledMode 4) are read from the analysis thread's LED reader,
+ or pushed by the main thread in show mode, and ramped from the value on
+ screen to each new frame over the interval between frames, so a 250 Hz
+ output doesn't step at the analysis rate.
+
+ start() runs tick() on a thread at `rate` Hz. Without it (--led-rate 0)
+ the app calls tick() once per frame. Every tick is recorded
+ (EVENT_LED_TICK), and a replay calls tick() at exactly the recorded
+ times instead, so it renders and writes at the same moments whichever
+ way the recording was driven.
+ */
+
+struct ledControl {
+    int mode;
+    int scene;
+    float bpm;
+    int beat;                   // 1-4, 0 = beat clock stopped
+    uint64_t beatMicros;        // when the next beat is due
+};
+
+struct ledBands {
+    uint64_t seq;
+    uint64_t traceId;
+    float val[BAND_NUM];
+};
+
+class ledScheduler : public ofThread {
+
+public:
+    ledScheduler();
+
+    void setup(deviceRegistry *d, eventLog *log, analysisThread *a, float gamma, bool dither);
+    void start(float rate);
+
+    /* main thread: fill control() and publish() whenever something changed */
+    ledControl & control();
+    void publish();
+    /* main thread, show mode: band values to use instead of the analysis thread's */
+    void pushBands(const float *val);
+
+    /* render and write one output frame for time `micros` */
+    void tick(uint64_t micros);
+
+    ledSequencer sequencer;     // load() before start()
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> late;         // ticks that started more than a period behind
+
+protected:
+    void threadedFunction();
+
+private:
+    void applyMode(int mode, uint64_t micros);
+    void setGroup(int group, int value);
+    bool nextBands(ledBands &b);
+    void renderBands(uint64_t micros);
+    void pinMode(int channel, int mode, uint64_t micros);
+    void digital(int channel, int value, uint64_t micros);
+    void pwm(int channel, int value, uint64_t micros);
+
+    deviceRegistry *devices;
+    eventLog *recorder;
+    analysisThread *analysis;
+    ledCurves curves;
+    float rate;
+
+    tripleBuffer<ledControl> controls;
+    tripleBuffer<ledBands> pushed;
+    uint64_t pushSeq;
+
+    int mode;
+    int scene;
+    bool bPwm;                  // current mode drives the channels with PWM, not digital
+    int value[MAX_CHANNELS];    // rendered brightness, 0..LED_FULL
+
+    /* band ramp: from `from` at `arrived` to `to` one interval later */
+    uint64_t bandSeq, traceId;
+    float from[BAND_NUM], to[BAND_NUM];
+    uint64_t arrived, interval;
+};
@@ -0,0 +1,157 @@
+#include "ledSequencer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the original ledMode 3 sequence, one step per beat, four lights
+static const char *defaultSteps[] = {
+    "1000", "1100", "1110", "1111", "0111", "0011", "0001", "0000",
+    "1001", "1111", "0110", "0000", "1010", "1111", "0101", "0000"
+};
+
+ledSequencer::ledSequencer(){
+    seqPattern p;
+    p.name = "default";
+    p.columns = 0;
+    p.stepsPerBeat = 1;
+    p.bBar = true;
+    p.bDimmed = false;
+    for(size_t i=0;i<sizeof(defaultSteps)/sizeof(defaultSteps[0]);i++)parseStep(defaultSteps[i], 255, p);
+    patterns.push_back(p);
+    current = 0;
+    reset();
+}
+
+bool ledSequencer::load(const std::string &path){
+    FILE *fp = fopen(path.c_str(), "r");
+    if(fp == NULL){
+        error = "can't open " + path;
+        return false;
+    }
+    std::vector<seqPattern> loaded;
+    char line[512];
+    int lineNumber = 0;
+    bool ok = true;
+    while(ok && fgets(line, sizeof(line), fp) != NULL){
+        lineNumber++;
+        char *hash = strchr(line, '#');
+        if(hash != NULL)*hash = 0;
+        char word[256], name[256], sync[16];
+        int stepsPerBeat, level = 255;
+        int n = sscanf(line, "%255s", word);
+        if(n < 1)continue;      // blank or comment
+        if(strcmp(word, "pattern") == 0){
+            if(sscanf(line, "%*s %255s %d %15s", name, &stepsPerBeat, sync) != 3 || stepsPerBeat < 1
+               || (strcmp(sync, "bar") != 0 && strcmp(sync, "loop") != 0)){
+                ok = false;
+            }else{
+                seqPattern p;
+                p.name = name;
+                p.columns = 0;
+                p.stepsPerBeat = stepsPerBeat;
+                p.bBar = strcmp(sync, "bar") == 0;
+                p.bDimmed = false;
+                loaded.push_back(p);
+            }
+        }else{
+            // at most one more token, and it must be a whole number
+            char extra[256], junk[2];
+            int more = sscanf(line, "%*s %255s %1s", extra, junk);
+            if(more >= 1){
+                char *end;
+                long v = strtol(extra, &end, 10);
+                level = more == 1 && *end == 0 && v >= 0 && v <= 255 ? (int)v : -1;
+            }
+            ok = !loaded.empty() && level >= 0 && level <= 255 && parseStep(word, level, loaded.back());
+        }
+        if(!ok){
+            char where[32];
+            snprintf(where, sizeof(where), ":%d: ", lineNumber);
+            error = path + where + "expected 'pattern NAME STEPS_PER_BEAT bar|loop' or a step like '0110 [LEVEL]'"
+                    + " (at most 64 columns, the same for every step)";
+        }
+    }
+    fclose(fp);
+    for(size_t i=0;ok&&i<loaded.size();i++){
+        if(loaded[i].steps.empty()){
+            error = path + ": pattern " + loaded[i].name + " has no steps";
+            ok = false;
+        }
+    }
+    if(ok && loaded.empty()){
+        error = path + " has no patterns";
+        ok = false;
+    }
+    if(!ok)return false;
+    patterns = loaded;
+    current = 0;
+    reset();
+    return true;
+}
+
+bool ledSequencer::parseStep(const char *text, int level, seqPattern &p){
+    int columns = strlen(text);
+    if(columns > SEQ_MAX_COLUMNS || (p.columns > 0 && columns != p.columns))return false;
+    seqStep s;
+    s.mask = 0;
+    s.level = level;
+    for(int i=0;i<columns;i++){
+        if(text[i] == '1')s.mask |= (uint64_t)1 << i;
+        else if(text[i] != '0')return false;
+    }
+    p.columns = columns;
+    if(s.mask != 0 && level != 255)p.bDimmed = true;
+    p.steps.push_back(s);
+    return true;
+}
+
+//--------------------------------------------------------------
+int ledSequencer::numPatterns() const{
+    return patterns.size();
+}
+
+int ledSequencer::selected() const{
+    return current;
+}
+
+const seqPattern & ledSequencer::pattern() const{
+    return patterns[current];
+}
+
+void ledSequencer::select(int index){
+    if(index < 0 || index >= (int)patterns.size())return;
+    current = index;
+    reset();
+}
+
+void ledSequencer::reset(){
+    step = -1;
+    lastTick = -1;
+}
+
+bool ledSequencer::advance(int beat, float phase){
+    if(beat < 1)return false;
+    const seqPattern &p = patterns[current];
+    if(phase < 0)phase = 0;
+    int sub = (int)(phase * p.stepsPerBeat);
+    if(sub >= p.stepsPerBeat)sub = p.stepsPerBeat - 1;
+    int tick = ((beat - 1) % 4) * p.stepsPerBeat + sub;
+    if(tick == lastTick)return false;
+    lastTick = tick;
+
+    if(step >= 0 && ++step >= (int)p.steps.size())step = -1;
+    // a bar pattern (re)starts only on the downbeat
+    if(step < 0 && (!p.bBar || tick == 0))step = 0;
+    return step >= 0;
+}
+
+void ledSequencer::render(int *values, int count) const{
+    if(step < 0)return;     // between runs the last step stays up
+    const seqPattern &p = patterns[current];
+    const seqStep &s = p.steps[step];
+    int level = s.level * LED_FULL / 255;
+    for(int i=0,col=0;i<count;i++){
+        values[i] = (s.mask >> col) & 1 ? level : 0;
+        if(++col == p.columns)col = 0;
+    }
+}
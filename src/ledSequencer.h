@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "ledCurves.h"
+
+#define SEQ_MAX_COLUMNS 64
+
+/*
+ ledSequencer
+
+ Step patterns for ledMode 3. A pattern is a list of steps; each step is
+ a bitmask over the pattern's columns plus one brightness for the lit
+ ones. Columns repeat across the LED channels (channel i shows column
+ i % columns), so a 4-column pattern drives any number of lights.
+
+ advance() is called every frame with the beat clock and moves at most
+ one step when the next beat subdivision starts; render() writes the
+ current step into a channel buffer. Neither depends on how many steps
+ or patterns there are.
+
+ Patterns (the "scenes" selectable with select()) load from a text file:
+
+   # name     steps/beat  bar|loop
+   pattern    chase       1  bar
+   1000                     <- one step: '1' lit, '0' dark, column 0 first
+   0100
+   0010 128                 <- optional brightness for this step (default 255)
+   0001
+
+ A `bar` pattern waits for the downbeat before it starts and again after
+ its last step, so it stays locked to the bar; a `loop` pattern wraps
+ straight around. Without a file there is one built-in pattern, the
+ original 16-beat fill/clear sequence.
+ */
+
+struct seqStep {
+    uint64_t mask;
+    uint8_t level;
+};
+
+struct seqPattern {
+    std::string name;
+    int columns;
+    int stepsPerBeat;
+    bool bBar;
+    bool bDimmed;           // some step is neither off nor full: needs PWM pins
+    std::vector<seqStep> steps;
+};
+
+class ledSequencer {
+
+public:
+    ledSequencer();
+
+    bool load(const std::string &path);
+
+    int numPatterns() const;
+    int selected() const;
+    const seqPattern & pattern() const;
+    void select(int index);     // and start it from the top
+    void reset();
+
+    /* beat 1-4, phase 0..1 into the beat; true when a new step became current */
+    bool advance(int beat, float phase);
+    /* brightness 0..LED_FULL per channel */
+    void render(int *values, int count) const;
+
+    std::string error;
+
+private:
+    bool parseStep(const char *text, int level, seqPattern &p);
+
+    std::vector<seqPattern> patterns;
+    int current;
+    int step;               // -1: waiting for the downbeat
+    int lastTick;
+};
@@ -1,13 +1,38 @@
 #include "ofMain.h"
+#include "ofAppNoWindow.h"
 #include "ofApp.h"
+#include "appConfig.h"
+#include "offlineAnalysis.h"
 
 //========================================================================
-int main( ){
-	ofSetupOpenGL(1024,768,OF_WINDOW);			// <-------- setup the GL context
+int main(int argc, char *argv[]){
+	appConfig config;
+	if(!config.parse(argc, argv)){
+		config.printUsage();
+		return 1;
+	}
+	
+	if(config.analyze){
+		offlineAnalysis offline;
+		offline.threads = config.threads;
+		offline.csv = config.csv;
+		offline.outDir = config.outDir;
+		return offline.run(config.files);
+	}
+
+	ofAppNoWindow noWindow;
+	if(config.headless){
+		// installation mode: no GL context, no vsync, draw() does nothing
+		ofSetupOpenGL(&noWindow, 1024,768, OF_WINDOW);
+	}else{
+		ofSetupOpenGL(1024,768,OF_WINDOW);			// <-------- setup the GL context
+	}
 
 	// this kicks off the running of my app
 	// can be OF_WINDOW or OF_FULLSCREEN
 	// pass in width and height too:
-	ofRunApp(new ofApp());
+	ofApp * app = new ofApp();
+	app->config = config;
+	ofRunApp(app);
 
 }
@@ -0,0 +1,227 @@
+#include "mockArduino.h"
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+#define SET_PIN_MODE 0xF4
+#define REPORT_VERSION 0xF9
+#define START_SYSEX 0xF0
+#define END_SYSEX 0xF7
+#define SYSTEM_RESET 0xFF
+#define REPORT_FIRMWARE 0x79
+
+mockArduino::mockArduino(){
+    master = slave = -1;
+    baud = 57600;
+    bLean = false;
+    log = NULL;
+    output = NULL;
+    statsStart = statsBytes = 0;
+    bytes = 0;
+    cmd = 0;
+    numData = needData = 0;
+    bSysex = false;
+    bHandshake = false;
+    for(int i=0;i<16;i++)ports[i] = 0;
+    pinBytes = 0;
+    bHaveMark = false;
+    resetStats();
+}
+
+mockArduino::~mockArduino(){
+    if(isThreadRunning())waitForThread(true);
+    if(log)fclose(log);
+    if(slave >= 0)close(slave);
+    if(master >= 0)close(master);
+}
+
+bool mockArduino::setup(int b, bool leanProtocol, const string &logPath, serialOutput *o){
+    baud = b;
+    bLean = leanProtocol;
+    output = o;
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+        error = "can't create a pseudo-terminal";
+        return false;
+    }
+    path = ptsname(master);
+    // hold the slave open in raw mode: no echo before the app configures it, no hangup when it closes
+    slave = open(path.c_str(), O_RDWR | O_NOCTTY);
+    if(slave < 0){
+        error = "can't open " + path;
+        return false;
+    }
+    struct termios t;
+    tcgetattr(slave, &t);
+    cfmakeraw(&t);
+    tcsetattr(slave, TCSANOW, &t);
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+    if(!logPath.empty()){
+        log = fopen(logPath.c_str(), "w");
+        if(log)fprintf(log, "micros,kind,pin,value,latency_us\n");
+        else ofLogError() << "can't write " << logPath;
+    }
+    startThread();
+    return true;
+}
+
+string mockArduino::devicePath() const{
+    return path;
+}
+
+//--------------------------------------------------------------
+void mockArduino::threadedFunction(){
+    uint64_t start = ofGetElapsedTimeMicros();
+    uint64_t lastAnnounce = 0;
+    uint8_t buf[256];
+    while(isThreadRunning()){
+        uint64_t now = ofGetElapsedTimeMicros();
+        // StandardFirmata announces itself after a reset; repeat until the host talks to us
+        if(!bLean && !bHandshake && now > lastAnnounce + 500000){
+            sendFirmware();
+            lastAnnounce = now;
+        }
+        // the baud rate decides how many bytes could have arrived by now
+        int64_t allowed = (int64_t)((now - start) * (uint64_t)baud / 10 / 1000000) - (int64_t)bytes;
+        if(allowed > (int64_t)sizeof(buf))allowed = sizeof(buf);
+        if(allowed > 0){
+            ssize_t n = read(master, buf, allowed);
+            for(ssize_t i=0;i<n;i++)receive(buf[i], now);
+            if(n > 0)bytes += n;
+            else start = now - bytes * 10 * 1000000 / baud;     // idle line: don't bank the unused time
+        }
+        sleep(1);
+    }
+}
+
+void mockArduino::receive(uint8_t b, uint64_t now){
+    if(bLean){
+        pinBytes++;
+        if(lean.feed(b)){
+            for(int i=0;i<lean.count;i++)pinWrite("lean", i, lean.values[i], now);
+        }
+        return;
+    }
+    if(bSysex){
+        if(b == END_SYSEX){
+            bSysex = false;
+            sysex();
+        }else if(numData < (int)sizeof(data)){
+            data[numData++] = b;
+        }
+        return;
+    }
+    if(b & 0x80){
+        cmd = b;
+        numData = 0;
+        bHandshake = true;
+        if(b == START_SYSEX)bSysex = true;
+        else if(b == REPORT_VERSION){
+            const uint8_t version[] = {REPORT_VERSION, 2, 5};
+            reply(version, 3);
+        }else if(b == SYSTEM_RESET){
+            for(int i=0;i<16;i++)ports[i] = 0;
+        }
+        if(b == SET_PIN_MODE || (b & 0xF0) == 0x90 || (b & 0xF0) == 0xE0)needData = 2;
+        else if((b & 0xF0) == 0xC0 || (b & 0xF0) == 0xD0)needData = 1;
+        else needData = 0;
+        return;
+    }
+    if(needData == 0)return;
+    data[numData++] = b;
+    if(numData == needData){
+        command(now);
+        numData = 0;    // running status: the same command may follow
+    }
+}
+
+void mockArduino::command(uint64_t now){
+    if(cmd == SET_PIN_MODE){
+        pinBytes += 3;
+        pinWrite("mode", data[0], data[1], now);
+    }else if((cmd & 0xF0) == 0x90){
+        pinBytes += 3;
+        int port = cmd & 0x0F;
+        int value = data[0] | (data[1] << 7);
+        for(int i=0;i<8;i++){
+            int bit = (value >> i) & 1;
+            if(bit != ((ports[port] >> i) & 1))pinWrite("digital", port*8+i, bit, now);
+        }
+        ports[port] = value;
+    }else if((cmd & 0xF0) == 0xE0){
+        pinBytes += 3;
+        pinWrite("pwm", cmd & 0x0F, data[0] | (data[1] << 7), now);
+    }
+}
+
+void mockArduino::sysex(){
+    if(numData > 0 && data[0] == REPORT_FIRMWARE)sendFirmware();
+    // capability / analog mapping / pin state queries go unanswered, ofArduino doesn't wait for them
+}
+
+void mockArduino::sendFirmware(){
+    const uint8_t version[] = {REPORT_VERSION, 2, 5};
+    reply(version, 3);
+    const char *name = "mockArduino";
+    uint8_t msg[64];
+    int n = 0;
+    msg[n++] = START_SYSEX;
+    msg[n++] = REPORT_FIRMWARE;
+    msg[n++] = 2;
+    msg[n++] = 5;
+    for(const char *c = name; *c; c++){
+        msg[n++] = *c & 0x7F;
+        msg[n++] = *c >> 7;
+    }
+    msg[n++] = END_SYSEX;
+    reply(msg, n);
+}
+
+void mockArduino::reply(const uint8_t *d, int size){
+    if(write(master, d, size) != size)ofLogWarning() << "mockArduino: reply dropped";
+}
+
+void mockArduino::pinWrite(const char *kind, int pin, int value, uint64_t now){
+    // find the commit whose flush contained the byte just decoded
+    while(output && (!bHaveMark || current.endByte < pinBytes)){
+        if(!output->nextFlushMark(current))break;
+        bHaveMark = true;
+    }
+    uint64_t lat = bHaveMark && current.endByte >= pinBytes && now > current.micros ? now - current.micros : 0;
+
+    writes++;
+    latencySum += lat;
+    if(lat > latencyMax)latencyMax = lat;
+    uint64_t bucket = lat / 1000;
+    latency[bucket < MOCK_LATENCY_BUCKETS ? bucket : MOCK_LATENCY_BUCKETS - 1]++;
+    if(log)fprintf(log, "%llu,%s,%d,%d,%llu\n", (unsigned long long)now, kind, pin, value, (unsigned long long)lat);
+}
+
+//--------------------------------------------------------------
+void mockArduino::resetStats(){
+    writes = 0;
+    latencySum = 0;
+    latencyMax = 0;
+    for(int i=0;i<MOCK_LATENCY_BUCKETS;i++)latency[i] = 0;
+    statsStart = ofGetElapsedTimeMicros();
+    statsBytes = bytes;
+}
+
+void mockArduino::printStats(const string &label){
+    double seconds = (ofGetElapsedTimeMicros() - statsStart) / 1000000.0;
+    uint64_t n = writes;
+    uint64_t p99 = 0, seen = 0;
+    for(int i=0;i<MOCK_LATENCY_BUCKETS;i++){
+        seen += latency[i];
+        if(seen * 100 >= n * 99){
+            p99 = i + 1;
+            break;
+        }
+    }
+    printf("%-12s %8.1f writes/s %8.1f bytes/s  latency avg %.2f ms  p99 <%llu ms  max %.2f ms\n",
+           label.c_str(), n / seconds, (bytes - statsBytes) / seconds,
+           n ? latencySum / 1000.0 / n : 0, (unsigned long long)p99, latencyMax / 1000.0);
+    if(bLean && lean.crcErrors)printf("%-12s %llu CRC errors\n", "", (unsigned long long)lean.crcErrors);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ofMain.h"
+#include "leanLed.h"
+#include "serialOutput.h"
+#include <atomic>
+#include <stdio.h>
+
+#define MOCK_LATENCY_BUCKETS 256    // 1ms each, the last one collects everything slower
+
+/*
+ mockArduino
+
+ A fake board on a pseudo-terminal, so the whole serial path runs without
+ hardware: connect serialOutput to devicePath() instead of a USB port.
+
+ It answers the Firmata init handshake (version and firmware report) and
+ decodes pin modes, digital port messages and PWM, or leanLed frames when
+ set up with `lean`. Bytes are taken off the pty no faster than `baud`
+ allows (10 bits per byte), so a link that's too slow shows up as
+ growing latency and, once the pty buffer fills, as a blocked writer.
+
+ Every decoded pin write is timestamped and, with a log path, written as
+ CSV: micros,kind,pin,value,latency_us. Latency runs from the commit()
+ that produced the write to the moment its last byte got through,
+ matched via serialOutput::nextFlushMark(). Only pin-write bytes are
+ counted for that, as those are the only ones serialOutput counts.
+ */
+
+class mockArduino : public ofThread {
+
+public:
+    mockArduino();
+    ~mockArduino();
+
+    bool setup(int baud, bool lean, const string &logPath, serialOutput *output);
+    string devicePath() const;
+
+    void resetStats();
+    void printStats(const string &label);
+
+    std::atomic<uint64_t> writes;       // decoded pin writes
+    std::atomic<uint64_t> bytes;        // bytes taken off the pty
+    std::atomic<uint64_t> latencySum;   // micros
+    std::atomic<uint64_t> latencyMax;
+    std::atomic<uint32_t> latency[MOCK_LATENCY_BUCKETS];
+    string error;
+
+private:
+    void threadedFunction();
+    void receive(uint8_t b, uint64_t now);
+    void command(uint64_t now);
+    void sysex();
+    void reply(const uint8_t *data, int size);
+    void sendFirmware();
+    void pinWrite(const char *kind, int pin, int value, uint64_t now);
+
+    int master, slave;
+    string path;
+    int baud;
+    bool bLean;
+    FILE *log;
+    serialOutput *output;
+    uint64_t statsStart, statsBytes;
+
+    /* firmata parser */
+    uint8_t cmd;
+    uint8_t data[64];
+    int numData, needData;
+    bool bSysex, bHandshake;
+    int ports[16];
+
+    leanLedDecoder lean;
+
+    /* wire position -> commit time */
+    uint64_t pinBytes;
+    flushMark current;
+    bool bHaveMark;
+};
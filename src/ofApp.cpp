@@ -1,172 +1,401 @@
 #include "ofApp.h"
+#include "oscCodec.h"
+#include "latencyTrace.h"
 
 //--------------------------------------------------------------
 void ofApp::setup(){
     //画面設定
-    ofSetVerticalSync(true);
-    ofSetFrameRate(60);
-    ofBackground(255,0,130);
-    
-    font.loadFont("Avenir.ttc", 14);
-    font.setLineHeight(14);
+    if(config.headless){
+        // no vsync to lock to: the loop runs on a timer, or per audio block when rate is 0
+        ofSetFrameRate(config.rate);
+    }else{
+        ofSetVerticalSync(true);
+        ofSetFrameRate(60);
+        ofBackground(255,0,130);
+        
+        font.loadFont("Avenir.ttc", 14);
+        font.setLineHeight(14);
+    }
+    /*-------------RECORD/REPLAY--------------*/
+    bReplay = false;
+    replayMicros = 0;
+    if(!config.replayPath.empty()){
+        if(replayLog.open(config.replayPath))bReplay = true;
+        else ofLogError() << replayLog.error;
+    }
+    if(!config.recordPath.empty()){
+        if(!recorder.create(config.recordPath, (size_t)config.recordMB << 20))ofLogError() << recorder.error;
+    }
     /*--------------arduino-------------*/
-    ard.connect("/dev/cu.usbmodem1411", 57600);
-    ofAddListener(ard.EInitialized, this, &ofApp::setupArduino);
-    bSetupArduino	= false;
+    // a replay never touches the hardware; its writes only go to the recorder
+    if(config.devicesPath.empty()||!devices.load(config.devicesPath)){
+        if(!config.devicesPath.empty())ofLogError() << devices.error;
+        int defaultPins[] = {3,5,6,9};
+        devices.addDevice(config.serialPort, config.baud, config.serialLean, vector<int>(defaultPins, defaultPins+4));
+    }
+    if(!bReplay)devices.connect(config.serialRate, config.mockArduino||config.serialBench>0, config.mockLog);
+    if(!config.patternsPath.empty()&&!leds.sequencer.load(config.patternsPath))ofLogError() << leds.sequencer.error;
+    benchMode = 0;
+    benchStart = 0;
     /*-------------OSC--------------*/
-    sender.setup(HOST,S_PORT);
-    receiver.setup(R_PORT);
+    if(config.oscDests.empty()&&!sender.setup(HOST,S_PORT))ofLogError() << sender.error;
+    for(size_t i=0;i<config.oscDests.size();i++){
+        const string & dest = config.oscDests[i];
+        size_t colon = dest.rfind(':');
+        if(colon==string::npos||!sender.addDestination(dest.substr(0,colon), ofToInt(dest.substr(colon+1)))){
+            ofLogError() << "bad OSC destination " << dest << " " << sender.error;
+        }
+    }
+    oscOut.setup(config.oscRate, config.oscPerBand);
+    if(!config.oscDelta.empty()){
+        // one epsilon for every band, or one per band
+        float eps[BAND_NUM];
+        for(int i=0;i<BAND_NUM;i++)eps[i] = config.oscDelta[MIN(i, (int)config.oscDelta.size()-1)];
+        oscOut.setDelta(eps, config.oscKeyframe);
+    }
+    if(!bReplay&&!receiver.setup(R_PORT))ofLogError() << receiver.error;
+    setupRoutes();
+    /*-------------SHOW-------------*/
+    for(int r=0;r<READER_NUM;r++){
+        for(int i=0;i<BAND_NUM;i++)onsetSeen[r][i] = 0;
+        showFrameSeen[r] = -1;
+    }
+    bShow = false;
+    if(!config.showTrack.empty()&&!bReplay){
+        string bands = config.showBands.empty() ? bandCurvePathFor(config.showTrack) : config.showBands;
+        if(!showCurves.open(ofToDataPath(bands)))ofLogError() << showCurves.error;
+        else if(!showPlayer.load(config.showTrack))ofLogError() << "can't load " << config.showTrack;
+        else{
+            bShow = true;
+            showPlayer.play();
+        }
+    }
     /*-------------FFT--------------*/
     srand((unsigned int)time((time_t *)NULL));
-    ofSoundStreamSetup(0,2,this, 44100,BUFFER_SIZE, 4);
-    left = new float[BUFFER_SIZE];
-    right = new float[BUFFER_SIZE];
-    
+    // in show mode everything comes from the band curves: no input stream, no FFT
+    if(!bShow&&!bReplay)ofSoundStreamSetup(0,2,this, 44100,BUFFER_SIZE, 4);
     for (int i = 0; i < NUM_WINDOWS; i++){
         for (int j = 0; j < BUFFER_SIZE/2; j++){
             freq[i][j] = 0;
         }
     }
     myfft.setup();
+    analysis.setup(&ring, myfft, &profiler);
+    metrics.setup(&ring, &analysis, &devices, config.metricsInterval);
+    if(config.spectrumPort>0&&!bReplay)analysis.spectrum.setup(HOST, config.spectrumPort, config.spectrumF16 ? SPECTRUM_F16 : SPECTRUM_DB8);
+    // a replay analyzes each logged block synchronously, see replayFrame()
+    if(!bShow&&!bReplay)analysis.startThread();
+    /*-------------LED--------------*/
+    // show mode has no analysis results: update() pushes the band curves instead
+    leds.setup(&devices, &recorder, bShow ? NULL : &analysis, config.gamma, config.dither);
+    ledMode = 0;
+    setLedMode(config.ledMode);
+    bLedThread = config.ledRate>0&&!bReplay;
+    if(bLedThread)leds.start(config.ledRate);
     //fftMode=0;
+    
+    if(config.bpm>0)startBeat(config.bpm);
+}
+
+//--------------------------------------------------------------
+void ofApp::exit(){
+    if(!bShow&&!bReplay)ofSoundStreamClose();
+    if(analysis.isThreadRunning())analysis.waitForThread(true);
+    if(receiver.isThreadRunning())receiver.waitForThread(true);
+    if(leds.isThreadRunning())leds.waitForThread(true);
+    devices.close();
+    recorder.close();
+    TRACE_DUMP(ofToDataPath("latency_trace.json"));
 }
 
 //--------------------------------------------------------------
 void ofApp::update(){
-    ofBackground(150,150,150);
+    if(bReplay){
+        if(!replayFrame()){
+            cout<<"replay finished: "<<analysis.analyzed<<" blocks"<<endl;
+            ofExit();
+            return;
+        }
+    }
+    if(recorder.isRecording())recorder.append(EVENT_FRAME, clockMicros(), NULL, 0);
+    if(config.serialBench>0)stepSerialBench();
+    
+    if(config.headless){
+        if(config.rate==0&&!bShow&&config.replayPath.empty()){
+            // audio driven: wait (bounded) for the next analysis result
+            uint64_t last = analysis.analyzed;
+            for(int i=0;i<50&&analysis.analyzed==last;i++)ofSleepMillis(1);
+        }
+    }else{
+        ofBackground(150,150,150);
+    }
+    uint64_t stageStart = ofGetElapsedTimeMicros();
     updateArduino();
+    profiler.add(PROFILE_ARDUINO, ofGetElapsedTimeMicros()-stageStart);
     
     /*-----------OSC-------------*/
-    while(receiver.hasWaitingMessages()){
-        ofxOscMessage m;
-        receiver.getNextMessage(m);
-        
-        if(m.getAddress() == "/bpm"){
-            bpm = m.getArgAsInt32(0);
-            cout<<"BPM change! >>"<<bpm<<endl;
-        }
-        else{
-            string msg_string;
-            msg_string = m.getAddress();
-            msg_string += ": ";
-            for(int i = 0; i < m.getNumArgs(); i++){
-                msg_string += m.getArgTypeName(i);
-                msg_string += ":";
-                
-                if(m.getArgType(i) == OFXOSC_TYPE_INT32){
-                    msg_string += ofToString(m.getArgAsInt32(i));
-                }
-                else if(m.getArgType(i) == OFXOSC_TYPE_FLOAT){
-                    msg_string += ofToString(m.getArgAsFloat(i));
-                }
-                else if(m.getArgType(i) == OFXOSC_TYPE_STRING){
-                    msg_string += m.getArgAsString(i);
-                }
-                else{
-                    msg_string += "unknown";
-                }
-            }
-        }
+    stageStart = ofGetElapsedTimeMicros();
+    receiver.collect();
+    // cues timed before the next beat land before it ticks, so a /bpm or /ledMode
+    // bundle stamped for a beat takes effect on the frame that beat ticks (frame
+    // accurate only: the LED thread may already be a few ms into the beat)
+    uint64_t beatMicros = (uint64_t)targetTime*1000;
+    if(beat>0&&beatMicros<=clockMicros())applyOsc(beatMicros);
+    applyOsc(clockMicros());
+    profiler.add(PROFILE_OSC_RECEIVE, ofGetElapsedTimeMicros()-stageStart);
+    // with bAutoMaxGet the analysis moves map_max itself: follow it so the next setParams doesn't undo that
+    if(myfft.bAutoMaxGet&&!bShow){
+        const analysisResult & result = analysis.latest(READER_RENDER);
+        if(result.seq>0)for(int i=0;i<BAND_NUM;i++)myfft.map_max[i] = result.map_max[i];
     }
     
     if(beat>0){
-        nowTime = ofGetElapsedTimeMillis();
+        nowTime = clockMicros()/1000;
         if(nowTime>=targetTime){
             if(beat<4)beat++;
             else beat=1;
             float nextBeat = 1000/(bpm/60);
-            targetTime=nowTime+nextBeat;
+            // keep the grid: a late frame must not push every later beat back (ledScheduler runs ahead on it)
+            targetTime+=nextBeat;
+            if(targetTime<=nowTime)targetTime=nowTime+nextBeat;
             cout<<beat<<endl;
-            bBeatAttack=true;
         }
     }
-    if(myfft.val[0]>0){
+    uint64_t now = clockMicros();
+    if(oscOut.due(now)){
+        uint64_t traceId;
+        int onsets[BAND_NUM];
+        const float * vol = bandValues(READER_OSC, &traceId, onsets);
+        const oscTemplate * packet = oscOut.build(vol, onsets, beat);
+        TRACE_STAGE(traceId, TRACE_MAPPING_OSC);
+        if(packet)sendOsc(*packet);
+        TRACE_STAGE(traceId, TRACE_OSC_SEND);
+    }
+    
+    /*-----------METRICS-------------*/
+    metrics.countFrame(ofGetLastFrameTime());
+    profiler.addFrame(ofGetLastFrameTime()*1000);
+    if(metrics.due(now)){
         ofxOscMessage m;
-        m.setAddress("/vol");
-        m.addIntArg(myfft.val[0]);
-        m.addIntArg(myfft.val[1]);
-        m.addIntArg(myfft.val[2]);
-        m.addIntArg(myfft.val[3]);
-        sender.sendMessage(m,false);
+        metrics.fill(m, now);
+        sendOsc(m);
     }
 }
 
 //--------------------------------------------------------------
-void ofApp::setupArduino(const int & version) {
-    ofRemoveListener(ard.EInitialized, this, &ofApp::setupArduino);
-    for (int i = 0; i < 13; i++){
-        ard.sendDigitalPinMode(i, ARD_OUTPUT);
+static void onBpm(void *ctx, const oscArgs &args){
+    // the beat clock divides by it
+    float bpm = args.asFloat(0);
+    if(!(bpm>0))return;
+    ((ofApp *)ctx)->bpm = bpm;
+    cout<<"BPM change! >>"<<bpm<<endl;
+}
+
+static void onLedMode(void *ctx, const oscArgs &args){
+    int mode = args.asInt(0);
+    if(mode<0||mode>4)return;
+    ((ofApp *)ctx)->setLedMode(mode);
+}
+
+static void onScene(void *ctx, const oscArgs &args){
+    ((ofApp *)ctx)->selectScene(args.asInt(0));
+}
+
+static void onBandRange(void *ctx, const oscArgs &args){
+    ((fft *)ctx)->updateBandRange();
+}
+
+/*
+ remote control, all numbers may be int or float:
+   /bpm f (> 0)  /ledMode i (0-4)  /scene i  /smooth i  /smoothRate f
+   /band/bottom /band/top /map/min /map/max /map/newMin /map/newMax
+     with "i f" to set one band, or BAND_NUM numbers to set them all
+ The fft routes write the main thread's myfft only. /band/bottom and
+ /band/top are clamped to the spectrum right away, and onOsc() then
+ hands the whole tuning to the analysis thread (analysisThread::setParams),
+ which never sees the raw values.
+ */
+void ofApp::setupRoutes(){
+    router.addCall("/bpm", onBpm, this);
+    router.addCall("/ledMode", onLedMode, this);
+    router.addCall("/scene", onScene, this);
+    router.addBool("/smooth", &myfft.bSmooth);
+    router.addFloat("/smoothRate", &myfft.smoothRate);
+    router.addArray("/band/bottom", myfft.band_bottom, BAND_NUM, onBandRange, &myfft);
+    router.addArray("/band/top", myfft.band_top, BAND_NUM, onBandRange, &myfft);
+    router.addArray("/map/min", myfft.map_min, BAND_NUM);
+    router.addArray("/map/max", myfft.map_max, BAND_NUM);
+    router.addArray("/map/newMin", myfft.map_newMin, BAND_NUM);
+    router.addArray("/map/newMax", myfft.map_newMax, BAND_NUM);
+}
+
+//--------------------------------------------------------------
+void ofApp::onOsc(const char * packet, int size){
+    if(recorder.isRecording())recorder.append(EVENT_OSC_IN, clockMicros(), packet, size);
+    metrics.countOscReceived();
+    
+    const char * address;
+    oscArgs args;
+    // unknown addresses are only counted, see oscRouter::unmatched
+    if(parseOscMessage(packet, size, &address, args)){
+        router.dispatch(address, args);
+        analysis.setParams(myfft);
     }
-    bSetupArduino = true;
+}
+
+void ofApp::applyOsc(uint64_t until){
+    const oscPacket * p;
+    while((p = receiver.nextDue(until)) != NULL)onOsc(p->data, p->size);
+}
+
+//--------------------------------------------------------------
+void ofApp::sendOsc(const ofxOscMessage &m){
+    char packet[1024];
+    int size = encodeOscMessage(m, packet, sizeof(packet));
+    if(size>0)sendOsc(packet, size);
+}
+void ofApp::sendOsc(const oscTemplate &t){
+    sendOsc(t.data(), t.size());
+}
+void ofApp::sendOsc(const char * packet, int size){
+    if(recorder.isRecording())recorder.append(EVENT_OSC_OUT, clockMicros(), packet, size);
+    metrics.countOscSent();
+    if(!bReplay)sender.send(packet, size);
+}
+//--------------------------------------------------------------
+uint64_t ofApp::clockMicros(){
+    // replays run on the recorded clock so beat timing comes out the same
+    return bReplay ? replayMicros : ofGetElapsedTimeMicros();
+}
+
+//--------------------------------------------------------------
+bool ofApp::replayFrame(){
+    const eventHeader * e;
+    while((e = replayLog.next()) != NULL){
+        const void * p = replayLog.payload(e);
+        replayMicros = e->micros;
+        if(e->type==EVENT_FRAME){
+            return true;
+        }else if(e->type==EVENT_AUDIO){
+            const eventAudio * a = (const eventAudio *)p;
+            pushAudio((const float *)(a+1), a->bufferSize, a->nChannels, e->micros);
+            analysis.processPending();
+        }else if(e->type==EVENT_OSC_IN){
+            onOsc((const char *)p, e->size);
+        }else if(e->type==EVENT_LED_TICK){
+            leds.tick(e->micros);
+        }else if(e->type==EVENT_KEY){
+            onKey(((const eventInput *)p)->key);
+        }else if(e->type==EVENT_MOUSE){
+            const eventInput * in = (const eventInput *)p;
+            onMouse(in->x, in->y, in->key);
+        }
+        // EVENT_OSC_OUT / EVENT_FIRMATA are outputs: the replayed pipeline produces them again
+    }
+    return false;
+}
+
+//--------------------------------------------------------------
+/* --serial-bench: run every ledMode for N seconds against the mock board and print what the link did */
+void ofApp::stepSerialBench(){
+    uint64_t now = ofGetElapsedTimeMicros();
+    if(benchMode>0&&now<benchStart+(uint64_t)(config.serialBench*1000000))return;
+    if(benchMode>0)devices.printMockStats("ledMode "+ofToString(benchMode));
+    else{
+        printf("serial bench: %d device(s), %d channels, %.0f flushes/s\n", devices.numDevices(), devices.numChannels(), config.serialRate);
+        if(beat==0)startBeat(bpm>0 ? bpm : 120);
+    }
+    if(++benchMode>4){
+        ofExit();
+        return;
+    }
+    setLedMode(benchMode);
+    devices.resetMockStats();
+    benchStart = now;
+}
+//--------------------------------------------------------------
+void ofApp::setLedMode(int mode){
+    if(ledMode==mode)return;
+    ledMode=mode;
+    leds.control().mode = mode;
+    leds.publish();
+}
+void ofApp::selectScene(int index){
+    if(index<0||index>=leds.sequencer.numPatterns())return;
+    ledScene=index;
+    cout<<"scene "<<index<<endl;
+    leds.control().scene = index;
+    leds.publish();
+}
+//--------------------------------------------------------------
+void ofApp::startBeat(float newBpm){
+    if(!(newBpm>0))return;
+    bpm=newBpm;
+    beat=1;
+    nowTime=clockMicros()/1000;
+    float nextBeat = 1000/(bpm/60);
+    targetTime=nowTime+nextBeat;
 }
 //--------------------------------------------------------------
 void ofApp::updateArduino(){
-    ard.update();
-    /*-----------LED 点灯パターン----------*/
-    if(ledMode==1){
-        for(int i=0;i<4;i++){
-            if(beat==i+1){
-                ard.sendDigital(pin[i], ARD_HIGH);
-                if(i==0)ard.sendDigital(pin[3], ARD_LOW);
-                else ard.sendDigital(pin[i-1], ARD_LOW);
-            }
+    // the LED clock only needs the beat clock and, in show mode, the band curves
+    ledControl & c = leds.control();
+    c.bpm = bpm;
+    c.beat = beat;
+    c.beatMicros = (uint64_t)targetTime*1000;
+    leds.publish();
+    if(bShow)leds.pushBands(bandValues(READER_LED));
+    // a replay ticks at the recorded times, see replayFrame()
+    if(!bLedThread&&!bReplay)leds.tick(clockMicros());
+}
+//--------------------------------------------------------------
+const float * ofApp::bandValues(analysisReader reader, uint64_t * traceId, int * onsets){
+    if(traceId!=NULL)*traceId = UINT64_MAX;
+    if(onsets!=NULL)for(int i=0;i<BAND_NUM;i++)onsets[i] = 0;
+    // show mode: the pre-analyzed frame at the current playback position
+    if(bShow){
+        const bandCurveFrame * frame = showCurves.frameAt(showPlayer.getPositionMS()/1000.0);
+        if(frame==NULL||!showPlayer.isPlaying()){
+            static const float silence[BAND_NUM] = {0};
+            return silence;
         }
-    }else if(ledMode==2){
-        for(int i=0;i<4;i++)ard.sendPwm(pin[i],(int)(128+128 * sin(ofGetElapsedTimef()*2)));
-    }else if(ledMode==3){
-        if(lScene==0){
-            if(bBeatAttack){
-                if(beat==1&&l_cnt==0)l_cnt=1;
-                else if(l_cnt>0)l_cnt++;
-                for(int i=0;i<4;i++)if(l_cnt==i+1)ard.sendDigital(pin[i], ARD_HIGH);
-                for(int i=0;i<4;i++)if(l_cnt==i+5)ard.sendDigital(pin[i], ARD_LOW);
-                if(l_cnt==9){
-                    ard.sendDigital(pin[0], ARD_HIGH);
-                    ard.sendDigital(pin[3], ARD_HIGH);
-                }else if(l_cnt==10){
-                    ard.sendDigital(pin[1], ARD_HIGH);
-                    ard.sendDigital(pin[2], ARD_HIGH);
-                }else if(l_cnt==11){
-                    ard.sendDigital(pin[0], ARD_LOW);
-                    ard.sendDigital(pin[3], ARD_LOW);
-                }else if(l_cnt==12){
-                    ard.sendDigital(pin[1], ARD_LOW);
-                    ard.sendDigital(pin[2], ARD_LOW);
-                }else if(l_cnt==13){
-                    ard.sendDigital(pin[0], ARD_HIGH);
-                    ard.sendDigital(pin[2], ARD_HIGH);
-                }else if(l_cnt==14){
-                    ard.sendDigital(pin[1], ARD_HIGH);
-                    ard.sendDigital(pin[3], ARD_HIGH);
-                }else if(l_cnt==15){
-                    ard.sendDigital(pin[0], ARD_LOW);
-                    ard.sendDigital(pin[2], ARD_LOW);
-                }else if(l_cnt==16){
-                    ard.sendDigital(pin[1], ARD_LOW);
-                    ard.sendDigital(pin[3], ARD_LOW);
-                    l_cnt=0;
-                }
-                bBeatAttack=false;
+        int index = frame - showCurves.frames;
+        if(onsets!=NULL&&showFrameSeen[reader]!=index){
+            // count the onsets of every frame passed since this reader last looked
+            int from = showFrameSeen[reader]+1;
+            if(from>index||index-from>1000)from = index;    // restart or seek: just this frame
+            for(int n=from;n<=index;n++){
+                for(int i=0;i<BAND_NUM;i++)onsets[i] += (showCurves.frames[n].onsets >> i) & 1;
             }
-            
         }
-    }else if(ledMode==4){
-        for(int i=0;i<PIN_NUM;i++){
-            ard.sendPwm(pin[i], (int)rect_color[i]);
+        showFrameSeen[reader] = index;
+        return frame->val;
+    }
+    const analysisResult & result = analysis.latest(reader);
+    if(traceId!=NULL&&result.seq>0)*traceId = result.blockSeq;
+    if(onsets!=NULL){
+        for(int i=0;i<BAND_NUM;i++){
+            onsets[i] = result.onsetCount[i] - onsetSeen[reader][i];
+            onsetSeen[reader][i] = result.onsetCount[i];
         }
     }
+    return result.val;
 }
 //--------------------------------------------------------------
 void ofApp::draw(){
+    if(config.headless)return;
+    uint64_t renderStart = ofGetElapsedTimeMicros();
     /*-------------FFT---------------*/
     static int index=0;
-    float avg_power = 0.0f;
     if(index < 80)
         index += 1;
     else
         index = 0;
     
-    myfft.powerSpectrum(0,(int)BUFFER_SIZE/2, left,BUFFER_SIZE,&magnitude[0],&phase[0],&power[0],&avg_power);
+    // one latest() per frame: a second call would swap the slot `result` points into
+    const analysisResult & result = analysis.latest(READER_RENDER);
+    const float * magnitude = result.magnitude;
+    const float * vol = bShow ? bandValues(READER_RENDER) : result.val;
     
     for(int j=1; j < BUFFER_SIZE/2; j++) {
         freq[index][j] = magnitude[j];
@@ -183,20 +412,20 @@ void ofApp::draw(){
     }
     ofSetColor(255);
     for(int i=0;i<4;i++){
-        myfft.update(magnitude, i);
-        ofDrawCircle(150+i*250, 100, myfft.val[i]*50);
+        ofDrawCircle(150+i*250, 100, vol[i]*50);
         string string_index[] = {"low:","mid:","mid2:","high:"};
         ofDrawBitmapString(ofToString(string_index[i]), 50, 480+i*30);
         ofDrawBitmapString(ofToString(myfft.map_min[i]), 100, 480+i*30);
         ofDrawBitmapString(ofToString(myfft.map_max[i]), 150, 480+i*30);
         ofDrawBitmapString(ofToString(myfft.map_newMin[i]), 200, 480+i*30);
         ofDrawBitmapString(ofToString(myfft.map_newMax[i]), 250, 480+i*30);
-        ofDrawBitmapString(ofToString(myfft.temp_val),300,480+i*30);
+        ofDrawBitmapString(ofToString(result.level[i]),300,480+i*30);
     }
     ofSetColor(255);
     ofDrawBitmapString(ofToString(paramMode),100,450);
     ofDrawBitmapString("bSmooth "+ofToString(myfft.bSmooth)+":"+ofToString(myfft.smoothRate), 100, 620);
     ofDrawBitmapString("BPM:"+ofToString(bpm), 600, 670);
+    ofDrawBitmapString("serial writes:"+ofToString(devices.messages())+" suppressed:"+ofToString(devices.suppressed())+" coalesced:"+ofToString(devices.coalesced())+" led late:"+ofToString(leds.late.load()), 600, 690);
     if(myfft.bSelectPreset)ofDrawBitmapString("===SELECT PRESET(Press key 1-2, 0 is reset)=== ", 100, 650);
     
     if(myfft.bSmooth){
@@ -223,7 +452,6 @@ void ofApp::draw(){
         ofSetColor(0, 0, 0);
         font.drawString("Reset", 245, 678);
         myfft.bReset=false;
-        for(int i=0;i<3;i++)myfft.vol_max[i]=0;
     }
     
     if(myfft.bAutoMaxGet){
@@ -238,14 +466,25 @@ void ofApp::draw(){
         font.drawString("ManualGet", 370, 678);
     }
     for(int i=0;i<4;i++){
-        rect_color[i] = ofMap(myfft.val[i], 0, 2, 0, 255);
-        ofSetColor(rect_color[i], rect_color[i], rect_color[i]);
+        int color = ofMap(vol[i], 0, 2, 0, 255);
+        ofSetColor(color, color, color);
         ofDrawRectangle(400+i*150,450,120,120);
     }
+    profiler.add(PROFILE_RENDER, ofGetElapsedTimeMicros()-renderStart);
+    profiler.draw(620, 10);
 }
 
 //--------------------------------------------------------------
 void ofApp::keyPressed(int key){
+    // display only, so it works during replay and isn't recorded
+    if(key=='p')profiler.bVisible=!profiler.bVisible;
+    if(bReplay)return;      // keys come from the log while replaying
+    onKey(key);
+}
+
+//--------------------------------------------------------------
+void ofApp::onKey(int key){
+    if(recorder.isRecording())recorder.logInput(EVENT_KEY, clockMicros(), key, 0, 0, true);
     /*---------------------------------
      モード選択:
      ◆リターン：モード変更
@@ -254,6 +493,7 @@ void ofApp::keyPressed(int key){
      ◆シフト：平滑化オンオフ
      　キーの上下で平滑化係数の調整
      ◆右コマンド：プリセットの選択
+     ◆タブ：ledMode 3 のシーン切り替え
      
      ---------------------------------*/
     if(key==OF_KEY_RETURN){
@@ -277,46 +517,29 @@ void ofApp::keyPressed(int key){
         else if(key==OF_KEY_DOWN)bpm--;
         else if(key==OF_KEY_RIGHT)bpm+=2;
         else if(key==OF_KEY_LEFT)bpm-=2;
+        if(bpm<1)bpm=1;
     }
     
     if(!paramMode)myfft.changeBandRange(key);
     else if(paramMode)myfft.changeParam(key);
     
     /*-----------LED--------------*/
+    if(bShow&&key==' '){
+        // restart the show from the top
+        showPlayer.stop();
+        showPlayer.play();
+    }
+    if(key==OF_KEY_TAB){
+        selectScene((ledScene+1)%leds.sequencer.numPatterns());
+    }
     if(!paramMode){
         if(key=='a'){
-            bpm=112;
-            beat=1;
-            nowTime=ofGetElapsedTimeMillis();
-            float nextBeat = 1000/(bpm/60);
-            targetTime=nowTime+nextBeat;
-        }else if(key=='1'){
-            if(ledMode!=1){
-                ledMode=1;
-                for(int i=0;i<4;i++)ard.sendDigitalPinMode(pin[i],ARD_OUTPUT);
-            }
-        }else if(key=='2'){
-            if(ledMode!=2){
-                ledMode=2;
-                for(int i=0;i<4;i++)ard.sendDigitalPinMode(pin[i], ARD_PWM);
-            }
-        }else if(key=='3'){
-            if(ledMode!=3){
-                ledMode=3;
-                for(int i=0;i<4;i++){
-                    ard.sendDigitalPinMode(pin[i], ARD_OUTPUT);
-                    ard.sendDigital(pin[i], ARD_LOW);
-                }
-            }
-        }else if(key=='4'){
-            if(ledMode!=4){
-                ledMode=4;
-                for(int i=0;i<4;i++){
-                    ard.sendDigitalPinMode(pin[i], ARD_PWM);
-                }
-            }
+            startBeat(112);
+        }else if(key>='1'&&key<='4'){
+            setLedMode(key-'0');
         }
     }
+    analysis.setParams(myfft);
 }
 
 //--------------------------------------------------------------
@@ -327,12 +550,21 @@ void ofApp::keyReleased(int key){
 //--------------------------------------------------------------
 
 void ofApp::mousePressed(int x, int y, int button){
+    if(bReplay)return;
+    onMouse(x, y, button);
+}
+
+void ofApp::onMouse(int x, int y, int button){
+    if(recorder.isRecording())recorder.logInput(EVENT_MOUSE, clockMicros(), button, x, y, true);
     if((x>=230&&x<330)&&(y>=650&&y<700)){
+        // the button only lights up for a frame, the peaks are cleared by the analysis
         if(!myfft.bReset)myfft.bReset=true;
+        analysis.resetMax();
     }
     if((x>=360&&x<460)&&(y>=650&&y<700)){
         if(!myfft.bAutoMaxGet)myfft.bAutoMaxGet=true;
         else myfft.bAutoMaxGet=false;
+        analysis.setParams(myfft);
     }
 }
 
@@ -342,10 +574,11 @@ void ofApp::mouseReleased(int x, int y, int button){
 }
 
 void ofApp::audioReceived 	(float * input, int bufferSize, int nChannels){
-    // samples are "interleaved"
-    for (int i = 0; i < bufferSize; i++){
-        left[i] = input[i*2];
-        right[i] = input[i*2+1];
-    }
-    bufferCounter++;
+    pushAudio(input, bufferSize, nChannels, ofGetElapsedTimeMicros());
+}
+
+void ofApp::pushAudio(const float * input, int bufferSize, int nChannels, uint64_t micros){
+    if(recorder.isRecording())recorder.logAudio(micros, input, bufferSize, nChannels);
+    TRACE_BEGIN(ring.received);
+    ring.push(input, bufferSize, nChannels, micros);
 }
\ No newline at end of file
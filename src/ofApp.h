@@ -4,18 +4,27 @@
 #include "ofEvents.h"
 #include "ofxOsc.h"
 #include "fft.h"
+#include "audioRing.h"
+#include "analysisThread.h"
+#include "appConfig.h"
+#include "bandCurveFile.h"
+#include "eventLog.h"
+#include "runtimeMetrics.h"
+#include "stageProfiler.h"
+#include "oscOutput.h"
+#include "oscRouter.h"
+#include "oscReceiver.h"
+#include "oscSocket.h"
+#include "deviceRegistry.h"
+#include "ledScheduler.h"
 #include "math.h"
 
 #define HOST "localhost"
 #define S_PORT 9000
 #define R_PORT 9001
-#define NUM_MSG_STRINGS 20
 
-#define BUFFER_SIZE 256
 #define NUM_WINDOWS 80
 
-#define PIN_NUM 4
-
 
 class ofApp : public ofBaseApp{
     
@@ -23,15 +32,35 @@ public:
     void setup();
     void update();
     void draw();
+    void exit();
     
     void keyPressed(int key);
     void keyReleased(int key);
     void mousePressed(int x, int y, int button);
     void mouseReleased(int x, int y, int button);
-    void setupArduino(const int & version);
     void updateArduino();
+    void setLedMode(int mode);
+    void selectScene(int index);
+    void startBeat(float newBpm);
+    const float * bandValues(analysisReader reader, uint64_t * traceId = NULL, int * onsets = NULL);
     void audioReceived 	(float * input, int bufferSize, int nChannels);
     
+    /* everything below is reached both from live input and from replay */
+    void onKey(int key);
+    void onMouse(int x, int y, int button);
+    void onOsc(const char * packet, int size);
+    void applyOsc(uint64_t until);
+    void setupRoutes();
+    void pushAudio(const float * input, int bufferSize, int nChannels, uint64_t micros);
+    void sendOsc(const ofxOscMessage &m);
+    void sendOsc(const oscTemplate &t);
+    void sendOsc(const char * packet, int size);
+    uint64_t clockMicros();
+    bool replayFrame();
+    void stepSerialBench();
+    
+    
+    appConfig config;
     
     ofImage img;
     ofTrueTypeFont font;
@@ -40,35 +69,43 @@ public:
     bool bEditBpm;
     
     /*--------Arduino(LED)------*/
-    ofArduino ard;
-    bool bSetupArduino;
-    int pin[4]={3,5,6,9};
+    deviceRegistry devices;         // logical channel -> board and pin, one writer thread per board
+    ledScheduler leds;              // renders the LED modes and writes them, on its own clock
+    bool bLedThread;                // false: leds.tick() runs in update() (--led-rate 0) or from the replay log
+    int benchMode;
+    uint64_t benchStart;
     int ledMode=1;
-    int lScene=0;
-    bool bBeatAttack;
-    int l_cnt=0;
+    int ledScene=0;
     
     /*--------OSC---------*/
-    ofxOscSender sender;
-    ofxOscReceiver receiver;
-    int current_mgs_string;
-    string msg_strings[NUM_MSG_STRINGS];
-    float timers[NUM_MSG_STRINGS];
+    oscSocket sender;
+    oscReceiver receiver;
+    oscOutput oscOut;
+    oscRouter router;
     float beat,temp_beat;
     
     /*--------FFT----------*/
-    float * left;
-    float * right;
-    int 	bufferCounter;
+    audioRing ring;
+    analysisThread analysis;
+    runtimeMetrics metrics;
+    stageProfiler profiler;
     fft		myfft;
     
-    float magnitude[BUFFER_SIZE];
-    float phase[BUFFER_SIZE];
-    float power[BUFFER_SIZE];
+    /*--------RECORD/REPLAY---------*/
+    eventLog recorder;
+    eventLog replayLog;
+    bool bReplay;
+    uint64_t replayMicros;
+    
+    /*--------SHOW---------*/
+    uint32_t onsetSeen[READER_NUM][BAND_NUM];   // per reader, for bandValues()
+    int showFrameSeen[READER_NUM];
+    bool bShow;
+    ofSoundPlayer showPlayer;
+    bandCurveMap showCurves;
     
     float freq[NUM_WINDOWS][BUFFER_SIZE/2];
     float freq_phase[NUM_WINDOWS][BUFFER_SIZE/2];
-    int rect_color[3];
     int fftMode,preset_index;
     bool paramMode;
     
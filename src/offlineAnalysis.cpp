@@ -0,0 +1,144 @@
+#include "offlineAnalysis.h"
+#include "wavFile.h"
+#include "bandAnalyzer.h"
+#include "bandCurveFile.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+
+struct segment {
+    int file;
+    size_t firstBlock;
+    size_t endBlock;
+};
+
+static std::string outputPath(const std::string &in, const std::string &outDir, bool csv){
+    std::string name = in;
+    if(!outDir.empty()){
+        size_t slash = name.find_last_of('/');
+        if(slash != std::string::npos)name = name.substr(slash + 1);
+        name = outDir + "/" + name;
+    }
+    return bandCurvePathFor(name, csv);
+}
+
+static void analyzeSegment(const wavFile &wav, const segment &seg, int warmupBlocks, std::vector<bandCurveFrame> &frames){
+    fft f;
+    f.setup();
+    bandAnalyzer analyzer;
+    analyzer.setup(&f);
+    analysisResult result;
+    float block[BUFFER_SIZE];
+
+    size_t total = wav.samples.size();
+    size_t start = seg.firstBlock > (size_t)warmupBlocks ? seg.firstBlock - warmupBlocks : 0;
+    for(size_t b = start; b < seg.endBlock; b++){
+        size_t offset = b * BUFFER_SIZE;
+        for(int i=0;i<BUFFER_SIZE;i++)block[i] = offset + i < total ? wav.samples[offset + i] : 0;
+        analyzer.process(block, result);
+        if(b < seg.firstBlock)continue;
+
+        bandCurveFrame &frame = frames[b];
+        frame.onsets = 0;
+        for(int i=0;i<BAND_NUM;i++){
+            frame.val[i] = result.val[i];
+            if(result.onset[i])frame.onsets |= 1u << i;
+        }
+    }
+}
+
+template<class F>
+static void parallelFor(int threads, size_t count, F func){
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    for(int t=0;t<threads;t++){
+        pool.push_back(std::thread([&](){
+            for(size_t i = next++; i < count; i = next++)func(i);
+        }));
+    }
+    for(size_t t=0;t<pool.size();t++)pool[t].join();
+}
+
+offlineAnalysis::offlineAnalysis(){
+    threads = 0;
+    segmentBlocks = 2048;   // ~12s at 44.1kHz
+    warmupBlocks = 128;     // lets the 0.95 onset envelope settle
+    csv = false;
+}
+
+int offlineAnalysis::run(const std::vector<std::string> &files){
+    if(files.empty()){
+        fprintf(stderr, "no input files\n");
+        return 1;
+    }
+    int workers = threads > 0 ? threads : std::thread::hardware_concurrency();
+    if(workers < 1)workers = 1;
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    /*-------decode-------*/
+    std::vector<wavFile> wavs(files.size());
+    std::vector<char> loaded(files.size(), 0);
+    parallelFor(workers, files.size(), [&](size_t i){
+        loaded[i] = wavs[i].load(files[i]);
+    });
+
+    /*-------cut into segments-------*/
+    std::vector<segment> segments;
+    std::vector<std::vector<bandCurveFrame> > curves(files.size());
+    double audioSeconds = 0;
+    for(size_t i=0;i<files.size();i++){
+        if(!loaded[i]){
+            fprintf(stderr, "%s\n", wavs[i].error.c_str());
+            continue;
+        }
+        if(wavs[i].sampleRate != 44100)fprintf(stderr, "%s: %d Hz, band bins assume 44100 Hz\n", files[i].c_str(), wavs[i].sampleRate);
+        size_t blocks = (wavs[i].samples.size() + BUFFER_SIZE - 1) / BUFFER_SIZE;
+        curves[i].resize(blocks);
+        audioSeconds += wavs[i].duration();
+        for(size_t b=0;b<blocks;b+=segmentBlocks){
+            segment seg;
+            seg.file = i;
+            seg.firstBlock = b;
+            seg.endBlock = b + segmentBlocks < blocks ? b + segmentBlocks : blocks;
+            segments.push_back(seg);
+        }
+    }
+
+    /*-------analyze-------*/
+    // the FFT bit-reversal table is built lazily on first use; do it here, before the workers race for it
+    {
+        fft f;
+        float in[BUFFER_SIZE] = {0}, magnitude[BUFFER_SIZE], phase[BUFFER_SIZE], power[BUFFER_SIZE], avg;
+        f.powerSpectrum(0, BUFFER_SIZE/2, in, BUFFER_SIZE, magnitude, phase, power, &avg);
+    }
+    int warmup = warmupBlocks;
+    parallelFor(workers, segments.size(), [&](size_t i){
+        const segment &seg = segments[i];
+        analyzeSegment(wavs[seg.file], seg, warmup, curves[seg.file]);
+    });
+
+    /*-------write-------*/
+    int failed = 0;
+    for(size_t i=0;i<files.size();i++){
+        if(!loaded[i]){
+            failed++;
+            continue;
+        }
+        std::string path = outputPath(files[i], outDir, csv);
+        bool ok = csv ? writeBandCurvesCsv(path, wavs[i].sampleRate, BUFFER_SIZE, curves[i])
+                      : writeBandCurves(path, wavs[i].sampleRate, BUFFER_SIZE, curves[i]);
+        if(!ok){
+            fprintf(stderr, "can't write %s\n", path.c_str());
+            failed++;
+            continue;
+        }
+        printf("%s -> %s (%d frames)\n", files[i].c_str(), path.c_str(), (int)curves[i].size());
+    }
+
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    printf("analyzed %.1fs of audio in %.2fs on %d threads: %.1fx realtime\n",
+           audioSeconds, wall, workers, wall > 0 ? audioSeconds / wall : 0.0);
+    return failed ? 1 : 0;
+}
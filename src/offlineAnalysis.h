@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ offlineAnalysis
+
+ Runs the live window/FFT/band-mapping pipeline (bandAnalyzer) over WAV
+ files as fast as the machine allows and writes the band curves and
+ onsets for each file (see bandCurveFile.h).
+
+ Files are cut into segments that are spread over a thread pool. Every
+ segment starts `warmupBlocks` early so the smoothing and onset state
+ has settled by the time its first frame is written; the band mapping
+ is run with fixed map_min/map_max (no AutoGetMax), otherwise segments
+ could not be computed independently.
+ */
+
+class offlineAnalysis {
+
+public:
+    offlineAnalysis();
+
+    /* returns a process exit code */
+    int run(const std::vector<std::string> &files);
+
+    int threads;            // 0 = hardware concurrency
+    int segmentBlocks;      // blocks per job
+    int warmupBlocks;       // blocks analyzed and discarded before each segment
+    bool csv;               // write .csv instead of the binary .bands format
+    std::string outDir;     // empty = next to each input file
+};
@@ -0,0 +1,192 @@
+#include "oscCodec.h"
+#include <string.h>
+
+static int padded(int n){
+    return (n + 4) & ~3;    // string + terminator, rounded up to 4 bytes
+}
+
+static void putU32(char *p, uint32_t v){
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static uint32_t getU32(const char *p){
+    const unsigned char *u = (const unsigned char *)p;
+    return ((uint32_t)u[0] << 24) | (u[1] << 16) | (u[2] << 8) | u[3];
+}
+
+static int putString(char *buf, int pos, int capacity, const char *s, int len){
+    int n = padded(len);
+    if(pos + n > capacity)return -1;
+    memcpy(buf + pos, s, len);
+    memset(buf + pos + len, 0, n - len);
+    return pos + n;
+}
+
+int encodeOscMessage(const ofxOscMessage &m, char *buf, int capacity){
+    char tags[64];
+    int numTags = 0;
+    tags[numTags++] = ',';
+    for(int i = 0; i < m.getNumArgs() && numTags < (int)sizeof(tags) - 1; i++){
+        ofxOscArgType t = m.getArgType(i);
+        if(t == OFXOSC_TYPE_INT32)tags[numTags++] = 'i';
+        else if(t == OFXOSC_TYPE_FLOAT)tags[numTags++] = 'f';
+        else if(t == OFXOSC_TYPE_STRING)tags[numTags++] = 's';
+    }
+
+    string address = m.getAddress();
+    int pos = putString(buf, 0, capacity, address.c_str(), address.size());
+    if(pos < 0)return -1;
+    pos = putString(buf, pos, capacity, tags, numTags);
+    if(pos < 0)return -1;
+
+    for(int i = 0; i < m.getNumArgs(); i++){
+        ofxOscArgType t = m.getArgType(i);
+        if(t == OFXOSC_TYPE_INT32 || t == OFXOSC_TYPE_FLOAT){
+            if(pos + 4 > capacity)return -1;
+            uint32_t v;
+            if(t == OFXOSC_TYPE_INT32)v = (uint32_t)m.getArgAsInt32(i);
+            else{
+                float f = m.getArgAsFloat(i);
+                memcpy(&v, &f, 4);
+            }
+            putU32(buf + pos, v);
+            pos += 4;
+        }else if(t == OFXOSC_TYPE_STRING){
+            string s = m.getArgAsString(i);
+            pos = putString(buf, pos, capacity, s.c_str(), s.size());
+            if(pos < 0)return -1;
+        }
+    }
+    return pos;
+}
+
+bool parseOscMessage(const char *buf, int size, const char **address, oscArgs &args){
+    args.num = 0;
+    int len = strnlen(buf, size);
+    if(len == size || buf[0] != '/')return false;
+    *address = buf;
+    int pos = padded(len);
+    if(pos >= size)return true;
+
+    const char *tags = buf + pos;
+    int numTags = strnlen(tags, size - pos);
+    if(numTags == size - pos || tags[0] != ',')return false;
+    pos += padded(numTags);
+    if(pos > size)return false;
+
+    for(int i = 1; i < numTags; i++){
+        char t = tags[i];
+        if(t == 'i' || t == 'f'){
+            if(pos + 4 > size)return false;
+            uint32_t v = getU32(buf + pos);
+            pos += 4;
+            float f;
+            memcpy(&f, &v, 4);
+            if(t == 'i')args.add('i', 0, (int32_t)v);
+            else args.add('f', f, 0);
+        }else if(t == 'T' || t == 'F'){
+            args.add('i', 0, t == 'T');
+        }else if(t == 's'){
+            int n = strnlen(buf + pos, size - pos);
+            if(n == size - pos)return false;
+            pos += padded(n);
+            if(pos > size)return false;
+            args.add('s', 0, 0);
+        }else if(t == 'b'){
+            if(pos + 4 > size)return false;
+            int n = (int)getU32(buf + pos);
+            pos += 4;
+            if(n < 0 || n > size - pos)return false;
+            pos += (n + 3) & ~3;
+            if(pos > size)return false;
+            args.add('b', 0, 0);
+        }else{
+            return false;
+        }
+    }
+    return true;
+}
+
+bool isOscBundle(const char *buf, int size){
+    return size >= 16 && memcmp(buf, "#bundle", 8) == 0;
+}
+
+uint64_t oscBundleTimetag(const char *buf){
+    return ((uint64_t)getU32(buf + 8) << 32) | getU32(buf + 12);
+}
+
+//--------------------------------------------------------------
+oscTemplate::oscTemplate(){
+    clear();
+}
+
+void oscTemplate::clear(){
+    length = 0;
+    numSlots = 0;
+    bBundle = false;
+}
+
+void oscTemplate::beginBundle(){
+    clear();
+    memcpy(buf, "#bundle", 8);
+    putU32(buf + 8, 0);
+    putU32(buf + 12, 1);
+    length = 16;
+    bBundle = true;
+}
+
+int oscTemplate::addMessage(const char *address, const char *types, int blobSize){
+    int start = length;
+    int pos = bBundle ? start + 4 : start;
+    int first = numSlots;
+
+    char tags[OSC_TEMPLATE_SLOTS + 2];
+    int numTags = strlen(types);
+    if(numSlots + numTags > OSC_TEMPLATE_SLOTS)return -1;
+    tags[0] = ',';
+    memcpy(tags + 1, types, numTags);
+
+    pos = putString(buf, pos, OSC_TEMPLATE_BYTES, address, strlen(address));
+    if(pos < 0)return -1;
+    pos = putString(buf, pos, OSC_TEMPLATE_BYTES, tags, numTags + 1);
+    if(pos < 0)return -1;
+    for(int i = 0; i < numTags; i++){
+        int n;
+        if(types[i] == 'i' || types[i] == 'f')n = 4;
+        else if(types[i] == 'b')n = 4 + ((blobSize + 3) & ~3);
+        else return -1;
+        if(pos + n > OSC_TEMPLATE_BYTES)return -1;
+        memset(buf + pos, 0, n);
+        if(types[i] == 'b')putU32(buf + pos, blobSize);
+        slots[numSlots++] = types[i] == 'b' ? pos + 4 : pos;
+        pos += n;
+    }
+    if(bBundle)putU32(buf + start, pos - start - 4);
+    length = pos;
+    return first;
+}
+
+void oscTemplate::setInt(int slot, int32_t v){
+    putU32(buf + slots[slot], (uint32_t)v);
+}
+
+void oscTemplate::setFloat(int slot, float v){
+    uint32_t u;
+    memcpy(&u, &v, 4);
+    putU32(buf + slots[slot], u);
+}
+
+char * oscTemplate::blob(int slot){
+    return buf + slots[slot];
+}
+
+const char * oscTemplate::data() const{
+    return buf;
+}
+
+int oscTemplate::size() const{
+    return length;
+}
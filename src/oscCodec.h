@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ofxOsc.h"
+#include "oscRouter.h"
+
+/*
+ oscCodec
+
+ OSC 1.0 wire format for ofxOscMessage, so the app can send and record
+ exactly the bytes it puts on the wire. int32, float and string
+ arguments are supported; other argument types are skipped.
+
+ oscTemplate is for hot-path output: address, type tags (and bundle
+ framing) are encoded once, later sends only patch argument bytes in
+ place. Argument types are limited to fixed-size i, f and b (blob of a
+ size given up front). Slots number the arguments across all messages.
+ */
+
+#define OSC_TEMPLATE_BYTES 1024
+#define OSC_TEMPLATE_SLOTS 64
+
+/* returns the packet size, or -1 if it doesn't fit */
+int encodeOscMessage(const ofxOscMessage &m, char *buf, int capacity);
+
+/* allocation free: `address` points into buf, numeric arguments (and T/F as 1/0) go to args */
+bool parseOscMessage(const char *buf, int size, const char **address, oscArgs &args);
+
+/* OSC bundles: "#bundle", 64-bit NTP timetag, then size-prefixed elements */
+bool isOscBundle(const char *buf, int size);
+uint64_t oscBundleTimetag(const char *buf);
+
+class oscTemplate {
+
+public:
+    oscTemplate();
+
+    void clear();
+    /* messages added after this go into one bundle, timetag "immediately" */
+    void beginBundle();
+    /* returns the slot of the first argument, -1 if it doesn't fit */
+    int addMessage(const char *address, const char *types, int blobSize = 0);
+
+    void setInt(int slot, int32_t v);
+    void setFloat(int slot, float v);
+    char * blob(int slot);
+
+    const char * data() const;
+    int size() const;
+
+private:
+    char buf[OSC_TEMPLATE_BYTES];
+    int length;
+    int slots[OSC_TEMPLATE_SLOTS];
+    int numSlots;
+    bool bBundle;
+};
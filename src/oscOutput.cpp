@@ -0,0 +1,83 @@
+#include "oscOutput.h"
+
+static const char * bandAddresses[BAND_NUM] = {"/vol/0", "/vol/1", "/vol/2", "/vol/3"};
+
+oscOutput::oscOutput(){
+    bDelta = false;
+    keyframe = 1;
+    for(int i=0;i<BAND_NUM;i++)epsilon[i] = 0;
+    setup(60, false);
+}
+
+void oscOutput::setup(float r, bool perBand){
+    rate = r;
+    bPerBand = perBand;
+    nextTick = tickMicros = nextKeyframe = 0;
+
+    packet.beginBundle();
+    volSlot = packet.addMessage("/vol", "ffff");
+    for(int i=0;i<BAND_NUM;i++)bandSlot[i] = bPerBand ? packet.addMessage(bandAddresses[i], "f") : -1;
+    beatSlot = packet.addMessage("/beat", "i");
+    onsetSlot = packet.addMessage("/onset", "iiii");
+}
+
+void oscOutput::setDelta(const float *eps, float keyframeSeconds){
+    bDelta = true;
+    for(int i=0;i<BAND_NUM;i++)epsilon[i] = eps[i];
+    keyframe = keyframeSeconds;
+    nextKeyframe = 0;
+}
+
+bool oscOutput::due(uint64_t micros){
+    if(rate <= 0 || micros < nextTick)return false;
+    uint64_t period = 1000000 / rate;
+    // stay on the grid, but don't try to catch up after a stall
+    nextTick = micros < nextTick + period ? nextTick + period : micros + period;
+    tickMicros = micros;
+    return true;
+}
+
+const oscTemplate * oscOutput::build(const float *val, const int *onsets, int beat){
+    if(bDelta&&tickMicros<nextKeyframe){
+        // no allocation here either: re-laying out a few short messages is just memcpy
+        delta.beginBundle();
+        bool changed[BAND_NUM];
+        bool anyChanged = false;
+        for(int i=0;i<BAND_NUM;i++){
+            changed[i] = fabsf(val[i]-lastVal[i])>epsilon[i];
+            anyChanged |= changed[i];
+        }
+        // same addresses as the full bundle: /vol whenever a band moved, /vol/N for the ones that did
+        if(anyChanged){
+            int slot = delta.addMessage("/vol", "ffff");
+            for(int i=0;i<BAND_NUM;i++)delta.setFloat(slot + i, val[i]);
+        }
+        for(int i=0;i<BAND_NUM;i++){
+            if(!changed[i])continue;
+            if(bPerBand)delta.setFloat(delta.addMessage(bandAddresses[i], "f"), val[i]);
+            lastVal[i] = val[i];
+        }
+        if(beat!=lastBeat){
+            delta.setInt(delta.addMessage("/beat", "i"), beat);
+            lastBeat = beat;
+        }
+        bool anyOnset = false;
+        for(int i=0;i<BAND_NUM;i++)anyOnset |= onsets[i]!=0;
+        if(anyOnset){
+            int slot = delta.addMessage("/onset", "iiii");
+            for(int i=0;i<BAND_NUM;i++)delta.setInt(slot + i, onsets[i]);
+        }
+        return delta.size() > 16 ? &delta : NULL;
+    }
+
+    for(int i=0;i<BAND_NUM;i++){
+        packet.setFloat(volSlot + i, val[i]);
+        if(bPerBand)packet.setFloat(bandSlot[i], val[i]);
+        packet.setInt(onsetSlot + i, onsets[i]);
+        lastVal[i] = val[i];
+    }
+    packet.setInt(beatSlot, beat);
+    lastBeat = beat;
+    nextKeyframe = tickMicros + (uint64_t)(keyframe * 1000000);
+    return &packet;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "ofMain.h"
+#include "oscCodec.h"
+#include "fft.h"
+
+/*
+ oscOutput
+
+ Everything the app sends per output tick, packed into one bundle:
+
+   /vol      f f f f      band values (full float resolution)
+   /vol/N    f            one message per band, if bPerBand
+   /beat     i            current beat 1-4 (0 = beat clock stopped)
+   /onset    i i i i      onsets per band since the previous tick
+
+ Ticks run at `rate` Hz on their own timer, independent of the frame rate
+ (capped by it, since they're sent from update()). The bundle is an
+ oscTemplate laid out once in setup(); a tick only patches the numbers.
+
+ Delta mode (setDelta) saves packets on busy networks: a tick sends /vol
+ (all bands) only when some band N moved more than epsilon[N] since it
+ was last sent, plus /vol/N for each band that did if bPerBand, /beat
+ when it changed and /onset when there were any, and nothing at all if
+ none of that happened. Every `keyframe` seconds the full
+ bundle goes out regardless, so late joiners and lost packets converge.
+ */
+
+class oscOutput {
+
+public:
+    oscOutput();
+
+    void setup(float rate, bool perBand);
+    void setDelta(const float *epsilon, float keyframeSeconds);
+    bool due(uint64_t micros);
+    /* NULL when delta mode has nothing to send */
+    const oscTemplate * build(const float *val, const int *onsets, int beat);
+
+    float rate;
+    bool bPerBand;
+    bool bDelta;
+    float epsilon[BAND_NUM];
+    float keyframe;
+
+private:
+    uint64_t nextTick, tickMicros, nextKeyframe;
+    oscTemplate packet, delta;
+    float lastVal[BAND_NUM];
+    int lastBeat;
+    int volSlot, bandSlot[BAND_NUM], beatSlot, onsetSlot;
+};
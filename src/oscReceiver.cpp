@@ -0,0 +1,169 @@
+#include "oscReceiver.h"
+#include "oscCodec.h"
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <string.h>
+
+#define NTP_UNIX_OFFSET 2208988800ULL   // seconds from 1900 to 1970
+
+static int64_t ntpNow(){
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)(((uint64_t)tv.tv_sec + NTP_UNIX_OFFSET) << 32) + (((uint64_t)tv.tv_usec << 32) / 1000000);
+}
+
+oscReceiver::oscReceiver(){
+    sock = -1;
+    arrivals = 0;
+    received = 0;
+    dropped = 0;
+    malformed = 0;
+    head = 0;
+    tail = 0;
+    numWaiting = 0;
+}
+
+oscReceiver::~oscReceiver(){
+    if(isThreadRunning())waitForThread(true);
+    if(sock >= 0)close(sock);
+}
+
+bool oscReceiver::setup(int port){
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if(sock < 0){
+        error = "can't create OSC socket";
+        return false;
+    }
+    int yes = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    // wake up regularly so stopThread() is noticed
+    struct timeval timeout = {0, 100000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if(bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0){
+        error = "can't bind OSC port " + ofToString(port);
+        close(sock);
+        sock = -1;
+        return false;
+    }
+    startThread();
+    return true;
+}
+
+void oscReceiver::threadedFunction(){
+    char buf[8192];
+    while(isThreadRunning()){
+        ssize_t n = recv(sock, buf, sizeof(buf), 0);
+        if(n <= 0)continue;     // timeout or interrupted
+        unpack(buf, (int)n, 0, 0);
+    }
+}
+
+/* UINT64_MAX: more than OSC_MAX_AHEAD seconds away */
+uint64_t oscReceiver::dueMicros(uint64_t timetag){
+    if(timetag <= 1)return 0;       // OSC "immediately"
+    int64_t delta = (int64_t)(timetag - ntpNow());
+    if(delta <= 0)return 0;
+    if(delta >= (int64_t)OSC_MAX_AHEAD << 32)return UINT64_MAX;
+    // 32.32 fixed point seconds -> micros, whole seconds and fraction apart so nothing overflows
+    uint64_t micros = (uint64_t)(delta >> 32) * 1000000 + (((uint64_t)delta & 0xffffffff) * 1000000 >> 32);
+    return ofGetElapsedTimeMicros() + micros;
+}
+
+void oscReceiver::unpack(const char *buf, int size, uint64_t due, int depth){
+    if(isOscBundle(buf, size)){
+        if(depth > 8){
+            malformed++;
+            return;
+        }
+        uint64_t t = dueMicros(oscBundleTimetag(buf));
+        if(t == UINT64_MAX){
+            dropped++;
+            return;
+        }
+        // a nested bundle can't be due before the bundle that contains it
+        if(t < due)t = due;
+        int pos = 16;
+        while(pos + 4 <= size){
+            const unsigned char *u = (const unsigned char *)buf + pos;
+            int n = (int)(((uint32_t)u[0] << 24) | (u[1] << 16) | (u[2] << 8) | u[3]);
+            pos += 4;
+            if(n <= 0 || n > size - pos){     // not pos + n: that overflows for n near INT_MAX
+                malformed++;
+                return;
+            }
+            unpack(buf + pos, n, t, depth + 1);
+            pos += n;
+        }
+    }else if(size > 0 && buf[0] == '/'){
+        push(buf, size, due);
+    }else{
+        malformed++;
+    }
+}
+
+void oscReceiver::push(const char *msg, int size, uint64_t due){
+    uint32_t h = head.load(std::memory_order_relaxed);
+    if(size > OSC_PACKET_MAX || h - tail.load(std::memory_order_acquire) >= OSC_QUEUE_SIZE){
+        dropped++;
+        return;
+    }
+    oscPacket &p = queue[h & (OSC_QUEUE_SIZE - 1)];
+    p.due = due;
+    p.size = size;
+    memcpy(p.data, msg, size);
+    head.store(h + 1, std::memory_order_release);
+    received++;
+}
+
+void oscReceiver::collect(){
+    uint32_t t = tail.load(std::memory_order_relaxed);
+    uint32_t h = head.load(std::memory_order_acquire);
+    for(;t != h;t++){
+        const oscPacket &p = queue[t & (OSC_QUEUE_SIZE - 1)];
+        if(numWaiting == OSC_PENDING_MAX){
+            dropped++;
+            continue;
+        }
+        oscPacket &w = waiting[numWaiting++];
+        w.due = p.due;
+        w.seq = arrivals++;
+        w.size = p.size;
+        memcpy(w.data, p.data, p.size);
+    }
+    tail.store(t, std::memory_order_release);
+}
+
+const oscPacket * oscReceiver::nextDue(uint64_t until){
+    int best = -1;
+    for(int i=0;i<numWaiting;i++){
+        const oscPacket &w = waiting[i];
+        if(w.due > until)continue;
+        if(best < 0 || w.due < waiting[best].due || (w.due == waiting[best].due && w.seq < waiting[best].seq))best = i;
+    }
+    if(best < 0)return NULL;
+    oscPacket &b = waiting[best];
+    current.due = b.due;
+    current.seq = b.seq;
+    current.size = b.size;
+    memcpy(current.data, b.data, b.size);
+    oscPacket &last = waiting[--numWaiting];
+    if(&b != &last){
+        b.due = last.due;
+        b.seq = last.seq;
+        b.size = last.size;
+        memcpy(b.data, last.data, last.size);
+    }
+    return &current;
+}
+
+int oscReceiver::pending() const{
+    return numWaiting;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ofMain.h"
+#include <atomic>
+#include <stdint.h>
+
+#define OSC_PACKET_MAX 512
+#define OSC_QUEUE_SIZE 256      // must be a power of two
+#define OSC_PENDING_MAX 256
+#define OSC_MAX_AHEAD 600       // seconds: bundles timed further ahead are dropped
+
+/*
+ oscReceiver
+
+ Receives OSC on its own thread from a plain UDP socket. Bundles are
+ unpacked there and every message is stamped with the time it is due:
+ its bundle's NTP timetag converted to ofGetElapsedTimeMicros(), or 0
+ for "immediately" (plain messages, timetag 1, or tags already past).
+ Bundles due more than OSC_MAX_AHEAD seconds from now are dropped, so
+ every pending message comes due within that bound, and at most
+ OSC_PENDING_MAX wait at once (more are dropped and counted).
+
+ Messages reach the main thread through a wait-free SPSC queue. collect()
+ moves them into a pending list and nextDue() hands them out in due-time
+ order (arrival order for equal times), so the caller can interleave
+ them with its own clock, e.g. apply everything stamped before a beat
+ before that beat ticks.
+
+ This is a pending queue, not sample-accurate scheduling: the handlers
+ change main-thread state, so ofApp applies due messages once per frame
+ and a message lands on the first frame at or after its due time (up to
+ a frame late, ~17 ms at 60 fps). Ordering is exact; timing is frame
+ accurate.
+ */
+
+struct oscPacket {
+    uint64_t due;           // ofGetElapsedTimeMicros() time, 0 = now
+    uint64_t seq;           // arrival order
+    int size;
+    char data[OSC_PACKET_MAX];  // one OSC message, no bundle framing
+};
+
+class oscReceiver : public ofThread {
+
+public:
+    oscReceiver();
+    ~oscReceiver();
+
+    bool setup(int port);
+
+    /* main thread */
+    void collect();
+    const oscPacket * nextDue(uint64_t until);
+    int pending() const;
+
+    std::atomic<uint64_t> received;     // messages queued by the receive thread
+    std::atomic<uint64_t> dropped;      // queue or pending list full, message too large or due too far ahead
+    std::atomic<uint64_t> malformed;    // packets that aren't OSC
+    string error;
+
+private:
+    void threadedFunction();
+    void unpack(const char *buf, int size, uint64_t due, int depth);
+    void push(const char *msg, int size, uint64_t due);
+    uint64_t dueMicros(uint64_t timetag);
+
+    int sock;
+    uint64_t arrivals;
+
+    oscPacket queue[OSC_QUEUE_SIZE];
+    char pad0[64];
+    std::atomic<uint32_t> head;     // written by the receive thread
+    char pad1[64];
+    std::atomic<uint32_t> tail;     // written by the main thread
+    char pad2[64];
+
+    oscPacket waiting[OSC_PENDING_MAX];
+    int numWaiting;
+    oscPacket current;
+};
@@ -0,0 +1,116 @@
+#include "oscRouter.h"
+#include <string.h>
+
+oscArgs::oscArgs(){
+    num = 0;
+}
+
+void oscArgs::add(char type, float fv, int32_t iv){
+    if(num >= OSC_MAX_ARGS)return;
+    types[num] = type;
+    f[num] = fv;
+    i[num] = iv;
+    num++;
+}
+
+float oscArgs::asFloat(int n) const{
+    return types[n] == 'i' ? (float)i[n] : f[n];
+}
+
+int32_t oscArgs::asInt(int n) const{
+    return types[n] == 'f' ? (int32_t)f[n] : i[n];
+}
+
+//--------------------------------------------------------------
+oscRouter::oscRouter(){
+    handled = 0;
+    unmatched = 0;
+    for(int k=0;k<OSC_ROUTE_SLOTS;k++)slots[k].address = NULL;
+}
+
+/* FNV-1a */
+uint32_t oscRouter::hash(const char *s){
+    uint32_t h = 2166136261u;
+    while(*s){
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+bool oscRouter::add(const char *address, oscRouteKind kind, void *target, int size, oscRouteFn fn, void *ctx){
+    uint32_t h = hash(address);
+    for(int k=0;k<OSC_ROUTE_SLOTS;k++){
+        route &r = slots[(h + k) & (OSC_ROUTE_SLOTS - 1)];
+        if(r.address && strcmp(r.address, address) != 0)continue;
+        r.hash = h;
+        r.address = address;
+        r.kind = kind;
+        r.target = target;
+        r.size = size;
+        r.fn = fn;
+        r.ctx = ctx;
+        return true;
+    }
+    return false;
+}
+
+bool oscRouter::addFloat(const char *address, float *target, oscRouteFn changed, void *ctx){
+    return add(address, ROUTE_FLOAT, target, 1, changed, ctx);
+}
+
+bool oscRouter::addInt(const char *address, int *target, oscRouteFn changed, void *ctx){
+    return add(address, ROUTE_INT, target, 1, changed, ctx);
+}
+
+bool oscRouter::addBool(const char *address, bool *target, oscRouteFn changed, void *ctx){
+    return add(address, ROUTE_BOOL, target, 1, changed, ctx);
+}
+
+bool oscRouter::addArray(const char *address, float *target, int size, oscRouteFn changed, void *ctx){
+    return add(address, ROUTE_ARRAY, target, size, changed, ctx);
+}
+
+bool oscRouter::addCall(const char *address, oscRouteFn fn, void *ctx, int numArgs){
+    return add(address, ROUTE_CALL, NULL, numArgs, fn, ctx);
+}
+
+const oscRouter::route * oscRouter::find(const char *address) const{
+    uint32_t h = hash(address);
+    for(int k=0;k<OSC_ROUTE_SLOTS;k++){
+        const route &r = slots[(h + k) & (OSC_ROUTE_SLOTS - 1)];
+        if(!r.address)return NULL;
+        if(r.hash == h && strcmp(r.address, address) == 0)return &r;
+    }
+    return NULL;
+}
+
+bool oscRouter::dispatch(const char *address, const oscArgs &args){
+    const route *r = find(address);
+    if(!r){
+        unmatched++;
+        return false;
+    }
+    if(args.num < (r->kind == ROUTE_CALL ? r->size : 1))return false;
+    for(int k=0;k<args.num;k++)if(args.types[k] != 'i' && args.types[k] != 'f')return false;
+    switch(r->kind){
+        case ROUTE_FLOAT: *(float *)r->target = args.asFloat(0); break;
+        case ROUTE_INT: *(int *)r->target = args.asInt(0); break;
+        case ROUTE_BOOL: *(bool *)r->target = args.asFloat(0) != 0; break;
+        case ROUTE_ARRAY:{
+            float *a = (float *)r->target;
+            if(args.num == 2 && args.types[0] == 'i'){
+                int index = args.i[0];
+                if(index < 0 || index >= r->size)return false;
+                a[index] = args.asFloat(1);
+            }else{
+                for(int k=0;k<args.num&&k<r->size;k++)a[k] = args.asFloat(k);
+            }
+            break;
+        }
+        case ROUTE_CALL: break;
+    }
+    if(r->fn)r->fn(r->ctx, args);
+    handled++;
+    return true;
+}
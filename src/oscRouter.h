@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define OSC_MAX_ARGS 16
+#define OSC_ROUTE_SLOTS 64      // must be a power of two
+
+/*
+ oscRouter
+
+ Address -> parameter dispatch for incoming OSC. Every route is hashed
+ once when it is added; dispatch hashes the incoming address in place,
+ probes a fixed open-addressed table and writes the arguments straight
+ into the target. Nothing is allocated per message.
+
+ Arguments arrive as an oscArgs view parsed straight from the packet
+ (see parseOscMessage). Numeric arguments convert freely: an int can set
+ a float parameter and vice versa. A message whose arguments aren't all
+ numbers, or are too few for the route, is rejected before anything is
+ written or called.
+
+ ROUTE_FLOAT / ROUTE_INT / ROUTE_BOOL   first argument -> *target
+ ROUTE_ARRAY   "i f" sets target[i], or n numbers set target[0..n-1]
+ ROUTE_CALL    hands at least `numArgs` arguments to a callback, which
+               validates their values itself
+ Every kind calls the route's callback (if any) after writing.
+ */
+
+struct oscArgs {
+    int num;
+    char types[OSC_MAX_ARGS];
+    float f[OSC_MAX_ARGS];
+    int32_t i[OSC_MAX_ARGS];
+
+    oscArgs();
+    void add(char type, float fv, int32_t iv);
+    float asFloat(int n) const;
+    int32_t asInt(int n) const;
+};
+
+enum oscRouteKind {
+    ROUTE_FLOAT,
+    ROUTE_INT,
+    ROUTE_BOOL,
+    ROUTE_ARRAY,
+    ROUTE_CALL
+};
+
+typedef void (*oscRouteFn)(void *ctx, const oscArgs &args);
+
+class oscRouter {
+
+public:
+    oscRouter();
+
+    /* `address` must outlive the router (string literals) */
+    bool addFloat(const char *address, float *target, oscRouteFn changed = NULL, void *ctx = NULL);
+    bool addInt(const char *address, int *target, oscRouteFn changed = NULL, void *ctx = NULL);
+    bool addBool(const char *address, bool *target, oscRouteFn changed = NULL, void *ctx = NULL);
+    bool addArray(const char *address, float *target, int size, oscRouteFn changed = NULL, void *ctx = NULL);
+    bool addCall(const char *address, oscRouteFn fn, void *ctx, int numArgs = 1);
+
+    /* returns false if no route matches, or the arguments don't fit it */
+    bool dispatch(const char *address, const oscArgs &args);
+
+    static uint32_t hash(const char *s);
+
+    uint64_t handled, unmatched;
+
+private:
+    struct route {
+        uint32_t hash;
+        const char *address;
+        oscRouteKind kind;
+        void *target;
+        int size;           // ROUTE_ARRAY: elements, ROUTE_CALL: arguments required
+        oscRouteFn fn;
+        void *ctx;
+    };
+    bool add(const char *address, oscRouteKind kind, void *target, int size, oscRouteFn fn, void *ctx);
+    const route * find(const char *address) const;
+
+    route slots[OSC_ROUTE_SLOTS];
+};
@@ -0,0 +1,90 @@
+#include "oscSocket.h"
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+oscSocket::oscSocket(){
+    sock = -1;
+    numDest = 0;
+    sent = 0;
+    failed = 0;
+}
+
+oscSocket::~oscSocket(){
+    if(sock >= 0)close(sock);
+}
+
+bool oscSocket::setup(const string &host, int port){
+    numDest = 0;
+    return addDestination(host, port);
+}
+
+bool oscSocket::addDestination(const string &host, int port){
+    if(numDest == OSC_MAX_DESTINATIONS){
+        error = "too many OSC destinations";
+        return false;
+    }
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if(getaddrinfo(host.c_str(), NULL, &hints, &res) != 0){
+        error = "can't resolve " + host;
+        return false;
+    }
+    struct sockaddr_in &addr = dest[numDest];
+    memcpy(&addr, res->ai_addr, sizeof(addr));
+    addr.sin_port = htons(port);
+    freeaddrinfo(res);
+
+    if(sock < 0)sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if(sock < 0){
+        error = "can't create OSC socket";
+        return false;
+    }
+#ifdef __linux__
+    // every message shares the one iovec, send() only points it at the packet
+    struct msghdr &h = msgs[numDest].msg_hdr;
+    memset(&msgs[numDest], 0, sizeof(msgs[numDest]));
+    h.msg_name = &addr;
+    h.msg_namelen = sizeof(addr);
+    h.msg_iov = &iov;
+    h.msg_iovlen = 1;
+#endif
+    numDest++;
+    return true;
+}
+
+int oscSocket::numDestinations() const{
+    return numDest;
+}
+
+bool oscSocket::send(const char *data, int size){
+    if(sock < 0)return false;
+    int ok = 0;
+#ifdef __linux__
+    iov.iov_base = (void *)data;
+    iov.iov_len = size;
+    // sendmmsg() stops at the first destination that fails: skip that one and go on with the rest
+    int i = 0;
+    while(i < numDest){
+        int n = sendmmsg(sock, msgs + i, numDest - i, 0);
+        if(n > 0){
+            ok += n;
+            i += n;
+        }else if(n < 0 && errno == EINTR){
+            continue;
+        }else{
+            i++;
+        }
+    }
+#else
+    for(int i = 0; i < numDest; i++){
+        if(sendto(sock, data, size, 0, (struct sockaddr *)&dest[i], sizeof(dest[i])) == size)ok++;
+    }
+#endif
+    sent += ok;
+    failed += numDest - ok;
+    return ok == numDest;
+}
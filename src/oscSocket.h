@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ofMain.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#define OSC_MAX_DESTINATIONS 16
+
+/*
+ oscSocket
+
+ Minimal UDP sender for already encoded OSC packets, nothing allocated or
+ copied on the way out. A packet is encoded once and goes to every
+ destination: in one sendmmsg() call on Linux (more only if a destination
+ fails: it is counted and skipped), one sendto() per destination
+ elsewhere.
+ */
+
+class oscSocket {
+
+public:
+    oscSocket();
+    ~oscSocket();
+
+    /* single destination, replaces any others */
+    bool setup(const string &host, int port);
+    bool addDestination(const string &host, int port);
+    int numDestinations() const;
+    /* true if every destination took the packet */
+    bool send(const char *data, int size);
+
+    uint64_t sent, failed;      // datagrams, counted per destination
+    string error;
+
+private:
+    int sock;
+    struct sockaddr_in dest[OSC_MAX_DESTINATIONS];
+    int numDest;
+#ifdef __linux__
+    struct mmsghdr msgs[OSC_MAX_DESTINATIONS];
+    struct iovec iov;
+#endif
+};
@@ -0,0 +1,58 @@
+#include "pinShadow.h"
+
+#define UNKNOWN -1
+
+pinShadow::pinShadow(){
+    written = 0;
+    suppressed = 0;
+    reset();
+}
+
+void pinShadow::reset(){
+    for(int i=0;i<SHADOW_PINS;i++)modes[i] = levels[i] = pwms[i] = UNKNOWN;
+}
+
+bool pinShadow::check(int16_t *slot, int pin, int value){
+    // out of range pins aren't tracked: always write
+    if(pin < 0 || pin >= SHADOW_PINS){
+        written.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    if(slot[pin] == value){
+        suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    slot[pin] = value;
+    written.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool pinShadow::mode(int pin, int m){
+    if(!check(modes, pin, m))return false;
+    if(pin >= 0 && pin < SHADOW_PINS)levels[pin] = pwms[pin] = UNKNOWN;
+    return true;
+}
+
+bool pinShadow::digital(int pin, int value){
+    if(!check(levels, pin, value))return false;
+    if(pin >= 0 && pin < SHADOW_PINS)pwms[pin] = UNKNOWN;
+    return true;
+}
+
+bool pinShadow::pwm(int pin, int value){
+    if(!check(pwms, pin, value))return false;
+    if(pin >= 0 && pin < SHADOW_PINS)levels[pin] = UNKNOWN;
+    return true;
+}
+
+int pinShadow::modeOf(int pin) const{
+    return pin >= 0 && pin < SHADOW_PINS ? modes[pin] : UNKNOWN;
+}
+
+int pinShadow::digitalOf(int pin) const{
+    return pin >= 0 && pin < SHADOW_PINS ? levels[pin] : UNKNOWN;
+}
+
+int pinShadow::pwmOf(int pin) const{
+    return pin >= 0 && pin < SHADOW_PINS ? pwms[pin] : UNKNOWN;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+#define SHADOW_PINS 70      // enough for a Mega
+
+/*
+ pinShadow
+
+ What the board was last told for every pin: mode, digital level and PWM
+ value. Each call returns true only if the write would change something,
+ and records it; redundant writes are counted and should be skipped.
+
+ A mode change makes the pin's level and PWM value unknown again, since
+ Firmata resets the output when it switches modes. reset() forgets
+ everything, e.g. after the board (re)connects.
+
+ Only one thread may write a shadow; the counters are atomic so others
+ can read them for metrics.
+ */
+
+class pinShadow {
+
+public:
+    pinShadow();
+
+    void reset();
+    bool mode(int pin, int mode);
+    bool digital(int pin, int value);
+    bool pwm(int pin, int value);
+
+    int modeOf(int pin) const;
+    int digitalOf(int pin) const;
+    int pwmOf(int pin) const;
+
+    std::atomic<uint64_t> written;      // writes that changed pin state
+    std::atomic<uint64_t> suppressed;   // writes skipped because nothing would change
+
+private:
+    bool check(int16_t *slot, int pin, int value);
+
+    int16_t modes[SHADOW_PINS];
+    int16_t levels[SHADOW_PINS];
+    int16_t pwms[SHADOW_PINS];
+};
@@ -0,0 +1,76 @@
+#include "runtimeMetrics.h"
+
+runtimeMetrics::runtimeMetrics(){
+    ring = NULL;
+    analysis = NULL;
+    devices = NULL;
+    interval = 1;
+    lastPublish = 0;
+    lastBusyMicros = lastAnalyzed = 0;
+    lastSerialBytes = lastSerialMessages = lastSuppressed = 0;
+    oscSent = oscReceived = 0;
+    frames = 0;
+    frameSeconds = frameMax = 0;
+}
+
+void runtimeMetrics::setup(audioRing *r, analysisThread *a, deviceRegistry *d, float intervalSeconds){
+    ring = r;
+    analysis = a;
+    devices = d;
+    interval = intervalSeconds;
+}
+
+void runtimeMetrics::countOscSent(){
+    oscSent++;
+}
+
+void runtimeMetrics::countOscReceived(){
+    oscReceived++;
+}
+
+void runtimeMetrics::countFrame(double seconds){
+    frames++;
+    frameSeconds += seconds;
+    if(seconds > frameMax)frameMax = seconds;
+}
+
+bool runtimeMetrics::due(uint64_t micros) const{
+    return interval > 0 && micros >= lastPublish + (uint64_t)(interval * 1000000);
+}
+
+void runtimeMetrics::fill(ofxOscMessage &m, uint64_t micros){
+    double elapsed = lastPublish > 0 ? (micros - lastPublish) / 1000000.0 : interval;
+    if(elapsed <= 0)elapsed = interval;
+
+    uint64_t analyzed = analysis->analyzed;
+    uint64_t busy = analysis->busyMicros;
+    uint64_t blocks = analyzed - lastAnalyzed;
+    uint64_t serialBytes = devices->bytes();
+    uint64_t serialMessages = devices->messages();
+    uint64_t suppressed = devices->suppressed();
+
+    m.setAddress("/metrics");
+    m.addIntArg((int)ring->received);
+    m.addIntArg((int)analyzed);
+    m.addIntArg((int)ring->overruns);
+    m.addIntArg(ring->available());
+    m.addFloatArg(blocks ? (busy - lastBusyMicros) / (float)blocks : 0);
+    m.addFloatArg(analysis->maxMicros.exchange(0));
+    m.addFloatArg(frames ? frameSeconds / frames * 1000 : 0);
+    m.addFloatArg(frameMax * 1000);
+    m.addFloatArg((serialBytes - lastSerialBytes) / elapsed);
+    m.addFloatArg((serialMessages - lastSerialMessages) / elapsed);
+    m.addFloatArg(oscSent / elapsed);
+    m.addFloatArg(oscReceived / elapsed);
+    m.addFloatArg((suppressed - lastSuppressed) / elapsed);
+
+    lastPublish = micros;
+    lastAnalyzed = analyzed;
+    lastBusyMicros = busy;
+    lastSuppressed = suppressed;
+    lastSerialBytes = serialBytes;
+    lastSerialMessages = serialMessages;
+    oscSent = oscReceived = 0;
+    frames = 0;
+    frameSeconds = frameMax = 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "audioRing.h"
+#include "analysisThread.h"
+#include "deviceRegistry.h"
+
+/*
+ runtimeMetrics
+
+ Health counters for the whole app, published every `interval` seconds as
+
+   /metrics  i:blocks received  i:blocks analyzed  i:blocks dropped  i:blocks queued
+             f:analysis us/block avg  f:analysis us/block max
+             f:frame ms avg  f:frame ms max
+             f:serial bytes/s  f:serial msgs/s  f:osc sent/s  f:osc received/s
+             f:redundant serial writes skipped/s
+
+ Block counts are totals since launch, everything else covers the last
+ interval. Serial counters are summed over all LED devices. Counters
+ other than the audio/analysis/serial ones are only touched from the
+ main thread.
+ */
+
+class runtimeMetrics {
+
+public:
+    runtimeMetrics();
+
+    void setup(audioRing *r, analysisThread *a, deviceRegistry *d, float intervalSeconds);
+
+    void countOscSent();
+    void countOscReceived();
+    void countFrame(double seconds);
+
+    bool due(uint64_t micros) const;
+    void fill(ofxOscMessage &m, uint64_t micros);
+
+    float interval;
+
+private:
+    audioRing *ring;
+    analysisThread *analysis;
+    deviceRegistry *devices;
+
+    uint64_t lastPublish;
+    uint64_t lastBusyMicros, lastAnalyzed;
+    uint64_t lastSerialBytes, lastSerialMessages, lastSuppressed;
+    uint64_t oscSent, oscReceived;
+    uint64_t frames;
+    double frameSeconds, frameMax;
+};
@@ -0,0 +1,207 @@
+#include "serialOutput.h"
+#include "latencyTrace.h"
+
+/* pin word: mode+1 | kind | value, 0 = nothing wanted */
+#define KIND_NONE 0
+#define KIND_DIGITAL 1
+#define KIND_PWM 2
+
+static uint32_t packPin(int mode, int kind, int value){
+    return ((uint32_t)(mode + 1) & 0xff) << 24 | (uint32_t)kind << 16 | ((uint32_t)value & 0xffff);
+}
+
+serialOutput::serialOutput(){
+    coalesced = 0;
+    bytes = 0;
+    messages = 0;
+    rate = 100;
+    for(int i=0;i<SHADOW_PINS;i++)wanted[i] = 0;
+    bChanged = false;
+    commits = 0;
+    for(int i=0;i<(SHADOW_PINS + 7) / 8;i++)portDirty[i] = false;
+    lastSeq = 0;
+    markHead = 0;
+    markTail = 0;
+    bLean = false;
+    numChannels = 0;
+    for(int i=0;i<LEAN_MAX_CHANNELS;i++)leanSent[i] = 0;
+    lastLeanFrame = 0;
+    initialized = false;
+    bResend = false;
+}
+
+serialOutput::~serialOutput(){
+    if(isThreadRunning())waitForThread(true);
+}
+
+void serialOutput::connect(const string &portName, int baud, float r, bool lean){
+    rate = r;
+    bLean = lean;
+    if(bLean){
+        // no handshake: the sketch just listens
+        if(!port.setup(portName, baud))return;
+        initialized = true;
+        bResend = true;
+    }else{
+        ard.connect(portName, baud);
+        ofAddListener(ard.EInitialized, this, &serialOutput::onInitialized);
+    }
+    startThread();
+}
+
+void serialOutput::setChannels(const int *pins, int count){
+    numChannels = count < LEAN_MAX_CHANNELS ? count : LEAN_MAX_CHANNELS;
+    for(int i=0;i<numChannels;i++)channels[i] = pins[i];
+}
+
+bool serialOutput::isInitialized() const{
+    return initialized;
+}
+
+//--------------------------------------------------------------
+bool serialOutput::pinMode(int pin, int mode){
+    if(pin < 0 || pin >= SHADOW_PINS || !requested.mode(pin, mode))return false;
+    wanted[pin] = packPin(mode, KIND_NONE, 0);
+    bChanged = true;
+    return true;
+}
+
+bool serialOutput::digital(int pin, int value){
+    if(pin < 0 || pin >= SHADOW_PINS || !requested.digital(pin, value))return false;
+    wanted[pin] = packPin(requested.modeOf(pin), KIND_DIGITAL, value);
+    bChanged = true;
+    return true;
+}
+
+bool serialOutput::pwm(int pin, int value){
+    if(pin < 0 || pin >= SHADOW_PINS || !requested.pwm(pin, value))return false;
+    wanted[pin] = packPin(requested.modeOf(pin), KIND_PWM, value);
+    bChanged = true;
+    return true;
+}
+
+void serialOutput::commit(uint64_t micros, uint64_t traceId){
+    if(!bChanged)return;
+    pinFrame &f = frames.back();
+    f.seq = ++commits;
+    f.micros = micros;
+    f.traceId = traceId;
+    for(int i=0;i<SHADOW_PINS;i++)f.word[i] = wanted[i];
+    frames.publish();
+    bChanged = false;
+}
+
+//--------------------------------------------------------------
+void serialOutput::onInitialized(const int &version){
+    // called from ard.update() on the worker: the board starts from scratch
+    ofRemoveListener(ard.EInitialized, this, &serialOutput::onInitialized);
+    sent.reset();
+    bResend = true;
+    initialized = true;
+}
+
+void serialOutput::threadedFunction(){
+    uint64_t period = 1000000 / (rate > 0 ? rate : 100);
+    uint64_t next = ofGetElapsedTimeMicros();
+    while(isThreadRunning()){
+        if(!bLean)ard.update();
+        else if(ofGetElapsedTimeMicros() > lastLeanFrame + 1000000)bResend = true;
+        const pinFrame &frame = frames.latest();
+        if(initialized && (frame.seq != lastSeq || bResend)){
+            if(frame.seq > lastSeq + 1)coalesced += frame.seq - lastSeq - 1;
+            lastSeq = frame.seq;
+            uint64_t before = bytes;
+            if(bLean)flushLean(frame);
+            else flush(frame);
+            if(bytes != before){
+                mark(frame.micros);
+                TRACE_STAGE(frame.traceId, TRACE_SERIAL_WRITE);
+            }
+            bResend = false;
+        }
+        next += period;
+        uint64_t now = ofGetElapsedTimeMicros();
+        if(next > now)sleep((next - now) / 1000);
+        else next = now;    // overran: don't try to catch up
+    }
+}
+
+void serialOutput::mark(uint64_t commitMicros){
+    uint32_t h = markHead.load(std::memory_order_relaxed);
+    if(h - markTail.load(std::memory_order_acquire) >= FLUSH_MARKS)return;     // nobody is listening
+    marks[h & (FLUSH_MARKS - 1)].endByte = bytes;
+    marks[h & (FLUSH_MARKS - 1)].micros = commitMicros;
+    markHead.store(h + 1, std::memory_order_release);
+}
+
+bool serialOutput::nextFlushMark(flushMark &m){
+    uint32_t t = markTail.load(std::memory_order_relaxed);
+    if(markHead.load(std::memory_order_acquire) == t)return false;
+    m = marks[t & (FLUSH_MARKS - 1)];
+    markTail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+void serialOutput::flush(const pinFrame &frame){
+    for(int pin=0;pin<SHADOW_PINS;pin++){
+        if(frame.word[pin])write(pin, frame.word[pin]);
+    }
+    for(int port=0;port<(SHADOW_PINS + 7) / 8;port++){
+        if(portDirty[port])writePort(port);
+    }
+}
+
+void serialOutput::write(int pin, uint32_t word){
+    int mode = (int)(word >> 24) - 1;
+    int kind = (word >> 16) & 0xff;
+    int value = word & 0xffff;
+    // every Firmata message here is 3 bytes: command, pin/port, value
+    if(mode >= 0 && sent.mode(pin, mode)){
+        ard.sendDigitalPinMode(pin, mode);
+        bytes += 3;
+        messages++;
+    }
+    if(kind == KIND_DIGITAL && sent.digital(pin, value)){
+        portDirty[pin / 8] = true;      // written once per port at the end of the flush
+    }else if(kind == KIND_PWM && sent.pwm(pin, value)){
+        ard.sendPwm(pin, value, true);     // our shadow decides, not ofArduino's cache
+        bytes += 3;
+        messages++;
+    }
+}
+
+void serialOutput::writePort(int p){
+    // Firmata only applies the bits of pins in OUTPUT mode, PWM pins in the port are left alone
+    int mask = 0;
+    for(int i=0;i<8&&p*8+i<SHADOW_PINS;i++){
+        if(sent.digitalOf(p*8+i) > 0)mask |= 1 << i;
+    }
+    ard.sendByte(FIRMATA_DIGITAL_MESSAGE | p);
+    ard.sendByte(mask & 0x7f);
+    ard.sendByte(mask >> 7);
+    bytes += 3;
+    messages++;
+    portDirty[p] = false;
+}
+
+void serialOutput::flushLean(const pinFrame &frame){
+    uint8_t values[LEAN_MAX_CHANNELS];
+    bool changed = bResend;
+    for(int i=0;i<numChannels;i++){
+        uint32_t word = frame.word[channels[i]];
+        int kind = (word >> 16) & 0xff;
+        int value = word & 0xffff;
+        if(kind == KIND_DIGITAL)values[i] = value ? 255 : 0;
+        else if(kind == KIND_PWM)values[i] = value > 255 ? 255 : value;
+        else values[i] = 0;
+        changed |= values[i] != leanSent[i];
+        leanSent[i] = values[i];
+    }
+    if(!changed)return;
+    uint8_t packet[LEAN_MAX_CHANNELS + 3];
+    int n = encodeLeanFrame(values, numChannels, packet);
+    port.writeBytes(packet, n);
+    bytes += n;
+    messages++;
+    lastLeanFrame = ofGetElapsedTimeMicros();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "ofMain.h"
+#include "pinShadow.h"
+#include "tripleBuffer.h"
+#include "leanLed.h"
+#include <atomic>
+
+/*
+ serialOutput
+
+ Owns the ofArduino connection and does all serial I/O on its own thread,
+ so a slow USB-serial write never stalls the main loop or the LED clock.
+
+ The producer (ledScheduler) only states what it wants each pin to be
+ (pinMode / digital / pwm) and commit()s once per output tick. A commit hands the whole
+ wanted pin state to the worker through a lock-free triple buffer, so
+ the worker always sees complete frames and several frames committed
+ between two flushes coalesce into one. The worker flushes `rate` times
+ a second and writes only what differs from the board's state (see
+ pinShadow).
+
+ Digital changes of one flush are batched into a single DIGITAL_MESSAGE
+ per 8-pin port, so multi-pin patterns switch together and cost 3 bytes
+ per port instead of per pin. When the board (re)initializes everything
+ is sent again.
+
+ With `lean` the board runs arduino/goisLeanLed instead of Firmata: each
+ flush that changes something sends one leanLed frame with the value of
+ every channel set by setChannels() (digital HIGH = 255), pin modes are
+ not sent at all. The frame is repeated every second so a board that
+ reset (e.g. on port open) picks the state up again.
+
+ Without connect() (replay, no board) requests are still tracked, only
+ nothing is written.
+ */
+
+#define FLUSH_MARKS 256     // must be a power of two
+
+struct pinFrame {
+    uint64_t seq;                   // commit number, 0 = nothing committed yet
+    uint64_t micros;                // commit time
+    uint64_t traceId;               // latencyTrace id of the band values behind it, UINT64_MAX if none
+    uint32_t word[SHADOW_PINS];     // packed mode / kind / value per pin
+};
+
+/* after a flush the port had taken `endByte` bytes in total, the last of them written for a commit at `micros` */
+struct flushMark {
+    uint64_t endByte;
+    uint64_t micros;
+};
+
+class serialOutput : public ofThread {
+
+public:
+    serialOutput();
+    ~serialOutput();
+
+    void connect(const string &port, int baud, float rate, bool lean = false);
+    /* lean protocol channel order */
+    void setChannels(const int *pins, int count);
+    bool isInitialized() const;
+
+    /* producer (ledScheduler) thread: return false if the request changes nothing */
+    bool pinMode(int pin, int mode);
+    bool digital(int pin, int value);
+    bool pwm(int pin, int value);
+    /* hand everything requested so far to the serial thread as one frame, due at `micros` */
+    void commit(uint64_t micros, uint64_t traceId = UINT64_MAX);
+
+    /* single consumer (mockArduino): maps bytes on the wire back to commit times */
+    bool nextFlushMark(flushMark &m);
+
+    pinShadow requested;                // producer view, counts redundant requests
+    std::atomic<uint64_t> coalesced;    // committed frames replaced before they were written
+    std::atomic<uint64_t> bytes;        // written to the port
+    std::atomic<uint64_t> messages;
+    float rate;
+
+private:
+    void threadedFunction();
+    void onInitialized(const int &version);
+    void flush(const pinFrame &frame);
+    void write(int pin, uint32_t word);
+    void writePort(int port);
+    void flushLean(const pinFrame &frame);
+    void mark(uint64_t commitMicros);
+
+    /* producer thread */
+    uint32_t wanted[SHADOW_PINS];
+    bool bChanged;
+    uint64_t commits;
+
+    tripleBuffer<pinFrame> frames;
+
+    /* serial thread */
+    ofArduino ard;
+    ofSerial port;
+    bool bLean;
+    int channels[LEAN_MAX_CHANNELS];
+    int numChannels;
+    uint8_t leanSent[LEAN_MAX_CHANNELS];
+    uint64_t lastLeanFrame;
+    pinShadow sent;
+    bool portDirty[(SHADOW_PINS + 7) / 8];
+    uint64_t lastSeq;
+    flushMark marks[FLUSH_MARKS];
+    std::atomic<uint32_t> markHead, markTail;
+    std::atomic<bool> initialized;
+    bool bResend;
+};
@@ -0,0 +1,66 @@
+#include "spectrumStream.h"
+#include <string.h>
+
+spectrumStream::spectrumStream(){
+    format = SPECTRUM_DB8;
+    bEnabled = false;
+    sequence = 0;
+    dbFloor = -40;
+    dbCeil = 40;
+}
+
+void spectrumStream::setup(const string &host, int port, spectrumFormat f){
+    format = f;
+    if(!socket.setup(host, port)){
+        ofLogError() << socket.error;
+        return;
+    }
+    int num = BUFFER_SIZE/2;
+    packet.clear();
+    packet.addMessage("/spec", "iib", format == SPECTRUM_DB8 ? num : num * 2);
+    bEnabled = true;
+}
+
+bool spectrumStream::isEnabled() const{
+    return bEnabled;
+}
+
+uint16_t spectrumStream::toHalf(float f){
+    uint32_t x;
+    memcpy(&x, &f, 4);
+    uint16_t sign = (x >> 16) & 0x8000;
+    int exponent = ((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = x & 0x7fffff;
+    if(((x >> 23) & 0xff) == 0xff)return sign | 0x7c00 | (mantissa ? 0x200 : 0);     // inf / nan
+    if(exponent >= 31)return sign | 0x7c00;                                          // overflow -> inf
+    if(exponent <= 0){
+        if(exponent < -10)return sign;                                               // underflow -> 0
+        mantissa |= 0x800000;                                                        // subnormal
+        return sign | (uint16_t)((mantissa >> (14 - exponent)) + ((mantissa >> (13 - exponent)) & 1));
+    }
+    uint16_t h = sign | (exponent << 10) | (mantissa >> 13);
+    return h + ((mantissa >> 12) & 1);     // round half up, carries into the exponent correctly
+}
+
+void spectrumStream::send(const analysisResult &result){
+    if(!bEnabled)return;
+    const int num = BUFFER_SIZE/2;
+    char *bins = packet.blob(2);
+    if(format == SPECTRUM_DB8){
+        float scale = 255.0f / (dbCeil - dbFloor);
+        for(int i=0;i<num;i++){
+            float db = 20.0f * log10f(result.magnitude[i] + 1e-6f);
+            float v = (db - dbFloor) * scale;
+            bins[i] = (char)(unsigned char)(v < 0 ? 0 : v > 255 ? 255 : v + 0.5f);
+        }
+    }else{
+        for(int i=0;i<num;i++){
+            uint16_t h = toHalf(result.magnitude[i]);
+            bins[i*2] = h >> 8;
+            bins[i*2+1] = h & 0xff;
+        }
+    }
+    packet.setInt(0, sequence++);
+    packet.setInt(1, format);
+    socket.send(packet.data(), packet.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ofMain.h"
+#include "oscCodec.h"
+#include "oscSocket.h"
+#include "bandAnalyzer.h"
+
+/*
+ spectrumStream
+
+ Streams the full magnitude spectrum of every analyzed block as one OSC
+ message, sent from the analysis thread so it runs at analysis rate:
+
+   /spec  i:sequence  i:format  b:bins
+
+ SPECTRUM_DB8   one byte per bin: dB mapped linearly from dbFloor..dbCeil to 0..255
+ SPECTRUM_F16   IEEE half float per bin, big-endian
+
+ With 128 bins the DB8 message is 156 bytes on the wire.
+ */
+
+enum spectrumFormat {
+    SPECTRUM_DB8,
+    SPECTRUM_F16
+};
+
+class spectrumStream {
+
+public:
+    spectrumStream();
+
+    void setup(const string &host, int port, spectrumFormat format);
+    bool isEnabled() const;
+    void send(const analysisResult &result);
+
+    static uint16_t toHalf(float f);
+
+    float dbFloor, dbCeil;
+
+private:
+    oscSocket socket;
+    oscTemplate packet;
+    spectrumFormat format;
+    bool bEnabled;
+    int sequence;
+};
@@ -0,0 +1,72 @@
+#include "stageProfiler.h"
+#include "ofMain.h"
+#include <algorithm>
+#include <stdio.h>
+
+static const char * stageNames[PROFILE_STAGE_NUM] = {"updateArduino", "OSC receive", "powerSpectrum", "band update", "render"};
+
+stageProfiler::stageProfiler(){
+    bVisible = false;
+    for(int s=0;s<PROFILE_STAGE_NUM;s++){
+        count[s] = 0;
+        for(int i=0;i<WINDOW;i++)samples[s][i] = 0;
+    }
+    for(int i=0;i<WINDOW;i++)frames[i] = 0;
+    frameCount = 0;
+}
+
+void stageProfiler::add(profileStage s, float micros){
+    unsigned int n = count[s].load(std::memory_order_relaxed);
+    samples[s][n % WINDOW] = micros;
+    count[s].store(n + 1, std::memory_order_release);
+}
+
+void stageProfiler::addFrame(float ms){
+    frames[frameCount % WINDOW] = ms;
+    frameCount++;
+}
+
+void stageProfiler::stats(profileStage s, float &min, float &avg, float &p99) const{
+    unsigned int n = std::min((unsigned int)WINDOW, count[s].load(std::memory_order_acquire));
+    min = avg = p99 = 0;
+    if(n == 0)return;
+
+    float sorted[WINDOW];
+    std::copy(samples[s], samples[s] + n, sorted);
+    std::sort(sorted, sorted + n);
+    float sum = 0;
+    for(unsigned int i=0;i<n;i++)sum += sorted[i];
+    min = sorted[0];
+    avg = sum / n;
+    p99 = sorted[std::min(n - 1, (unsigned int)(n * 0.99f))];
+}
+
+void stageProfiler::draw(float x, float y) const{
+    if(!bVisible)return;
+
+    ofSetColor(0, 0, 0, 180);
+    ofDrawRectangle(x, y, 390, 200);
+    ofSetColor(255);
+    ofDrawBitmapString("stage (us)          min      avg      p99", x+10, y+20);
+    for(int s=0;s<PROFILE_STAGE_NUM;s++){
+        float min, avg, p99;
+        stats((profileStage)s, min, avg, p99);
+        char line[96];
+        snprintf(line, sizeof(line), "%-16s %8.0f %8.0f %8.0f", stageNames[s], min, avg, p99);
+        ofDrawBitmapString(line, x+10, y+40+s*16);
+    }
+
+    /*------frame time graph: last WINDOW frames, 16.7ms line = 60fps------*/
+    float gx = x+10, gy = y+190, gh = 60;
+    ofSetColor(80);
+    ofDrawLine(gx, gy-gh*16.7f/33.3f, gx+WINDOW*1.4f, gy-gh*16.7f/33.3f);
+    ofSetColor(0, 255, 0);
+    unsigned int n = std::min((unsigned int)WINDOW, frameCount);
+    for(unsigned int i=1;i<n;i++){
+        float a = frames[(frameCount - n + i - 1) % WINDOW];
+        float b = frames[(frameCount - n + i) % WINDOW];
+        ofDrawLine(gx+(i-1)*1.4f, gy-gh*std::min(a, 33.3f)/33.3f, gx+i*1.4f, gy-gh*std::min(b, 33.3f)/33.3f);
+    }
+    ofSetColor(255);
+    ofDrawBitmapString("frame " + ofToString(n ? frames[(frameCount-1) % WINDOW] : 0, 1) + "ms", x+10, y+120);
+}
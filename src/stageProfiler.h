@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ stageProfiler
+
+ Rolling timing of the app's pipeline stages for the on-screen overlay
+ (toggle with 'p'). Each stage keeps its last WINDOW samples; min / avg /
+ p99 are computed from that window when the overlay is drawn. A stage is
+ only ever written by one thread (the analysis stages by the analysis
+ thread, the rest by the main thread), the overlay just reads.
+ */
+
+enum profileStage {
+    PROFILE_ARDUINO,            // updateArduino()
+    PROFILE_OSC_RECEIVE,        // draining the OSC receiver
+    PROFILE_POWER_SPECTRUM,     // fft::powerSpectrum per block
+    PROFILE_BAND_UPDATE,        // fft::update + onsets per block
+    PROFILE_RENDER,             // draw()
+    PROFILE_STAGE_NUM
+};
+
+class stageProfiler {
+
+public:
+    enum { WINDOW = 256 };
+
+    stageProfiler();
+
+    void add(profileStage s, float micros);
+    void addFrame(float ms);
+    void stats(profileStage s, float &min, float &avg, float &p99) const;
+    void draw(float x, float y) const;
+
+    bool bVisible;
+
+private:
+    float samples[PROFILE_STAGE_NUM][WINDOW];
+    std::atomic<unsigned int> count[PROFILE_STAGE_NUM];
+    float frames[WINDOW];
+    unsigned int frameCount;
+};
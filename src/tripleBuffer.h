@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+/*
+ tripleBuffer
+
+ Lock-free hand-off of the latest value from one writer thread to one
+ reader thread. The writer fills back(), then publish() swaps it with the
+ shared middle slot. The reader's latest() swaps the middle slot into
+ the front only when something new was published, so neither side ever
+ waits and the reader always sees a complete value.
+ */
+
+template<class T>
+class tripleBuffer {
+
+public:
+    tripleBuffer(){
+        backIndex = 0;
+        middle = 1;
+        frontIndex = 2;
+        for(int i=0;i<3;i++)slots[i] = T();
+    }
+
+    /* writer side */
+    T & back(){
+        return slots[backIndex];
+    }
+    void publish(){
+        backIndex = middle.exchange(backIndex | DIRTY, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /* reader side */
+    const T & latest(){
+        if(middle.load(std::memory_order_acquire) & DIRTY){
+            frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX;
+        }
+        return slots[frontIndex];
+    }
+
+private:
+    enum { INDEX = 3, DIRTY = 4 };
+    T slots[3];
+    uint8_t backIndex;                  // owned by the writer
+    std::atomic<uint8_t> middle;        // shared slot index + DIRTY flag
+    uint8_t frontIndex;                 // owned by the reader
+};
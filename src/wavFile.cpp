@@ -0,0 +1,96 @@
+#include "wavFile.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+static uint32_t readU32(const unsigned char *p){
+    return p[0] | (p[1]<<8) | (p[2]<<16) | ((uint32_t)p[3]<<24);
+}
+
+static uint16_t readU16(const unsigned char *p){
+    return p[0] | (p[1]<<8);
+}
+
+wavFile::wavFile(){
+    sampleRate = 0;
+    channels = 0;
+}
+
+double wavFile::duration() const{
+    if(sampleRate==0)return 0;
+    return samples.size() / (double)sampleRate;
+}
+
+bool wavFile::load(const std::string &path){
+    samples.clear();
+    FILE *fp = fopen(path.c_str(), "rb");
+    if(fp == NULL){
+        error = "can't open " + path;
+        return false;
+    }
+    std::vector<unsigned char> data;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    if(size > 0){
+        data.resize(size);
+        if(fread(&data[0], 1, size, fp) != (size_t)size)data.clear();
+    }
+    fclose(fp);
+
+    if(data.size() < 12 || memcmp(&data[0], "RIFF", 4) != 0 || memcmp(&data[8], "WAVE", 4) != 0){
+        error = path + " is not a RIFF/WAVE file";
+        return false;
+    }
+
+    int format = 0, bits = 0;
+    size_t pos = 12;
+    while(pos + 8 <= data.size()){
+        const unsigned char *chunk = &data[pos];
+        size_t len = readU32(chunk + 4);
+        size_t body = pos + 8;
+        if(body + len > data.size())len = data.size() - body;
+
+        if(memcmp(chunk, "fmt ", 4) == 0 && len >= 16){
+            format = readU16(chunk + 8);
+            channels = readU16(chunk + 10);
+            sampleRate = readU32(chunk + 12);
+            bits = readU16(chunk + 22);
+            if(format == 0xFFFE && len >= 26)format = readU16(chunk + 32);     // WAVE_FORMAT_EXTENSIBLE sub format
+        }else if(memcmp(chunk, "data", 4) == 0){
+            if(channels <= 0 || bits == 0){
+                error = path + ": data chunk before fmt chunk";
+                return false;
+            }
+            // decided before any sizes are worked out: a bit depth below 8 would make a frame 0 bytes
+            if(!((format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32))){
+                error = path + ": unsupported sample format";
+                return false;
+            }
+            int bytes = bits / 8;
+            size_t frameBytes = bytes * channels;
+            size_t frames = len / frameBytes;
+            samples.resize(frames);
+            const unsigned char *p = &data[body];
+            for(size_t i = 0; i < frames; i++, p += frameBytes){
+                float v;
+                if(format == 3 && bits == 32){
+                    uint32_t u = readU32(p);
+                    memcpy(&v, &u, 4);
+                }else if(format == 1 && bits == 16){
+                    v = (int16_t)readU16(p) / 32768.0f;
+                }else if(format == 1 && bits == 24){
+                    int32_t s = (int32_t)((p[0]<<8) | (p[1]<<16) | ((uint32_t)p[2]<<24)) >> 8;
+                    v = s / 8388608.0f;
+                }else{
+                    v = (int32_t)readU32(p) / 2147483648.0f;     // 32-bit PCM
+                }
+                samples[i] = v;
+            }
+            return true;
+        }
+        pos = body + len + (len & 1);
+    }
+    error = path + ": no data chunk";
+    return false;
+}
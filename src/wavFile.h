@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ wavFile
+
+ Minimal RIFF/WAVE decoder for the offline tools: 16/24/32-bit PCM and
+ 32-bit float, any channel count. Only the first channel is kept, which
+ is what the live pipeline analyzes (the left input).
+ */
+
+class wavFile {
+
+public:
+    wavFile();
+
+    bool load(const std::string &path);
+
+    int sampleRate;
+    int channels;
+    std::vector<float> samples;     // first channel, -1..1
+    std::string error;
+
+    double duration() const;
+};